@@ -0,0 +1,47 @@
+#include "arena.h"
+
+// Every allocation is rounded up to this alignment (enough for uint64_t).
+#define ARENA_ALIGN 8
+
+/**
+ * @brief Sets up an arena over a caller-provided block of memory.
+ * @param arena The arena control block.
+ * @param mem   Backing memory; should be ARENA_ALIGN aligned.
+ * @param size  Size of the backing memory in bytes.
+ */
+void arena_init(Arena *arena, void *mem, size_t size)
+{
+    arena->base = mem;
+    arena->size = size;
+    arena->used = 0;
+    arena->high_water = 0;
+    arena->fails = 0;
+}
+
+/**
+ * @brief Allocates 'size' bytes from the arena by bumping the offset.
+ *
+ * The memory is not zeroed and stays valid until the next arena_reset().
+ * @return Pointer to the memory, or NULL if the arena is exhausted.
+ */
+void *arena_alloc(Arena *arena, size_t size)
+{
+    size_t offset = (arena->used + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size > arena->size || offset > arena->size - size) {
+        arena->fails++;
+        return NULL;
+    }
+    arena->used = offset + size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+    return arena->base + offset;
+}
+
+/**
+ * @brief Releases every allocation made from the arena in O(1).
+ */
+void arena_reset(Arena *arena)
+{
+    arena->used = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef __ARENA_H_
+#define __ARENA_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Bump-pointer scratch arena.
+ * Alokasi hanya menaikkan offset 'used'; tidak ada free per objek. Seluruh isi
+ * arena dibuang sekaligus dengan arena_reset() dalam O(1).
+ */
+typedef struct Arena {
+    uint8_t *base;      // Awal memori arena
+    size_t size;        // Kapasitas total dalam byte
+    size_t used;        // Offset alokasi berikutnya
+    size_t high_water;  // Nilai 'used' tertinggi sejak arena_init()
+    uint32_t fails;     // arena_alloc() yang gagal karena arena penuh
+} Arena;
+
+void arena_init(Arena *arena, void *mem, size_t size);
+void *arena_alloc(Arena *arena, size_t size);
+void arena_reset(Arena *arena);
+
+#endif // __ARENA_H_
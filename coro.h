@@ -0,0 +1,51 @@
+#ifndef __CORO_H_
+#define __CORO_H_
+
+#include <stdint.h>
+#include "systick.h" // time_ticks() untuk CORO_SLEEP
+
+/*
+ * Coroutine stackless (protothread) berbasis local continuation switch/__LINE__.
+ * State satu coroutine hanya 'lc' (baris tempat ia berhenti) dan waktu bangun,
+ * jadi puluhan coroutine bisa bergantian di atas satu stack task.
+ *
+ * Aturan pemakaian:
+ * - Variabel lokal TIDAK bertahan melewati CORO_YIELD/CORO_WAIT_UNTIL/CORO_SLEEP;
+ *   simpan state di struct milik coroutine.
+ * - Jangan memakai 'switch' sendiri di antara CORO_BEGIN dan CORO_END, dan
+ *   jangan menaruh dua makro yield di baris yang sama.
+ * - Fungsi coroutine mengembalikan CORO_WAITING, CORO_YIELDED atau CORO_ENDED.
+ */
+typedef struct {
+    uint16_t lc;         // Local continuation: baris untuk dilanjutkan, 0 = awal
+    uint32_t wake_tick;  // Dipakai CORO_SLEEP
+} Coro;
+
+enum {
+    CORO_WAITING,   // Menunggu kondisi/waktu, panggil lagi nanti
+    CORO_YIELDED,   // Melepas CPU sukarela, boleh langsung dipanggil lagi
+    CORO_ENDED      // Selesai
+};
+
+#define CORO_INIT(c)    ((c)->lc = 0)
+
+#define CORO_BEGIN(c)   switch ((c)->lc) { case 0:
+
+#define CORO_END(c)     } (c)->lc = 0; return CORO_ENDED
+
+#define CORO_YIELD(c) \
+    do { (c)->lc = __LINE__; return CORO_YIELDED; case __LINE__:; } while (0)
+
+#define CORO_WAIT_UNTIL(c, cond) \
+    do { (c)->lc = __LINE__; case __LINE__: if (!(cond)) return CORO_WAITING; } while (0)
+
+// Tidur minimal 'ticks' tick SysTick tanpa memblok task yang menjalankan coroutine.
+#define CORO_SLEEP(c, ticks) \
+    do { \
+        (c)->wake_tick = time_ticks() + (ticks); \
+        CORO_WAIT_UNTIL(c, (int32_t)(time_ticks() - (c)->wake_tick) >= 0); \
+    } while (0)
+
+#define CORO_EXIT(c)    do { (c)->lc = 0; return CORO_ENDED; } while (0)
+
+#endif // __CORO_H_
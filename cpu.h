@@ -0,0 +1,142 @@
+#ifndef __CPU_H_
+#define __CPU_H_
+
+#include <stdint.h>
+
+/*
+ * cpu.h - Intrinsik inti Cortex-M3 yang dipakai bersama oleh kernel dan driver.
+ * Semua fungsi di sini 'static inline' sehingga tidak menambah simbol di image.
+ */
+
+/*
+ * RAMFUNC: menempatkan fungsi di section .ramfunc (dijalankan dari SRAM, lihat
+ * hello.ld). Jarak Flash (0x0) ke SRAM (0x20000000) melebihi jangkauan BL;
+ * linker otomatis menyisipkan veneer long branch untuk panggilan lintas region.
+ */
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+
+/**
+ * @brief Menonaktifkan interrupt (PRIMASK = 1) dan mengembalikan state sebelumnya.
+ *        Pasangkan selalu dengan irq_restore() agar critical section bisa bersarang.
+ */
+static inline uint32_t irq_save(void)
+{
+    uint32_t primask;
+    __asm__ volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+/**
+ * @brief Mengembalikan PRIMASK ke nilai yang disimpan oleh irq_save().
+ */
+static inline void irq_restore(uint32_t primask)
+{
+    __asm__ volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+/**
+ * @brief Mengembalikan 1 jika interrupt sedang dinonaktifkan lewat PRIMASK.
+ */
+static inline int irq_disabled(void)
+{
+    uint32_t primask;
+    __asm__ volatile ("mrs %0, primask" : "=r" (primask));
+    return primask & 1;
+}
+
+/**
+ * @brief Mengembalikan nomor exception yang sedang aktif (IPSR), 0 = Thread mode.
+ */
+static inline uint32_t cpu_ipsr(void)
+{
+    uint32_t ipsr;
+    __asm__ volatile ("mrs %0, ipsr" : "=r" (ipsr));
+    return ipsr;
+}
+
+/**
+ * @brief Menidurkan core sampai ada interrupt (Wait For Interrupt).
+ *        Jika dipanggil dengan PRIMASK = 1, core tetap bangun saat interrupt
+ *        pending, tetapi handler baru jalan setelah irq_restore().
+ */
+static inline void cpu_wfi(void)
+{
+    __asm__ volatile ("wfi" ::: "memory");
+}
+
+/**
+ * @brief Data Synchronization Barrier: tunggu semua akses memori/register selesai.
+ */
+static inline void cpu_dsb(void)
+{
+    __asm__ volatile ("dsb" ::: "memory");
+}
+
+/**
+ * @brief Instruction Synchronization Barrier: instruksi berikutnya melihat
+ *        efek perubahan konfigurasi (mis. IRQ yang baru dinonaktifkan).
+ */
+static inline void cpu_isb(void)
+{
+    __asm__ volatile ("isb" ::: "memory");
+}
+
+/**
+ * @brief Data Memory Barrier: akses memori sebelum barrier terlihat lebih dulu
+ *        daripada akses sesudahnya (mis. isi slot sebelum indeks ring).
+ */
+static inline void cpu_dmb(void)
+{
+    __asm__ volatile ("dmb" ::: "memory");
+}
+
+/**
+ * @brief Load-exclusive (LDREX): membaca word dan menandai alamatnya di monitor eksklusif.
+ */
+static inline uint32_t cpu_ldrex(volatile uint32_t *addr)
+{
+    uint32_t value;
+    __asm__ volatile ("ldrex %0, [%1]" : "=r" (value) : "r" (addr) : "memory");
+    return value;
+}
+
+/**
+ * @brief Store-exclusive (STREX): menulis hanya jika monitor masih utuh sejak
+ *        cpu_ldrex(). Mengembalikan 0 jika berhasil, 1 jika harus diulang.
+ *        Setiap masuk/keluar exception menghapus monitor, jadi interrupt di
+ *        antara LDREX dan STREX membuat STREX gagal.
+ */
+static inline uint32_t cpu_strex(uint32_t value, volatile uint32_t *addr)
+{
+    uint32_t failed;
+    __asm__ volatile ("strex %0, %2, [%1]" : "=&r" (failed) : "r" (addr), "r" (value) : "memory");
+    return failed;
+}
+
+/**
+ * @brief Menghapus monitor eksklusif (CLREX) saat LDREX tidak diikuti STREX.
+ */
+static inline void cpu_clrex(void)
+{
+    __asm__ volatile ("clrex" ::: "memory");
+}
+
+/**
+ * @brief Count Leading Zeros (instruksi CLZ), 32 jika x == 0.
+ */
+static inline uint32_t cpu_clz(uint32_t x)
+{
+    uint32_t n;
+    __asm__ ("clz %0, %1" : "=r" (n) : "r" (x));
+    return n;
+}
+
+/**
+ * @brief Menulis Process Stack Pointer (PSP), stack yang dipakai task di Thread mode.
+ */
+static inline void cpu_set_psp(uint32_t psp)
+{
+    __asm__ volatile ("msr psp, %0" :: "r" (psp) : "memory");
+}
+
+#endif // __CPU_H_
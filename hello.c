@@ -1,6 +1,23 @@
 #include <stdint.h> // Standard C header for fixed-width integer types (e.g., uint32_t, uint16_t).
 #include "reg.h"    // Custom header defining hardware register addresses, now updated for LM3S6965evb.
 #include <stddef.h> // Diperlukan untuk definisi NULL (size_t) dan NULL pointer.
+#include "cpu.h"    // Intrinsik Cortex-M3 (irq_save/irq_restore).
+#include "pool.h"   // Fixed-size object pool (slab) allocator.
+#include "arena.h"  // Bump-pointer scratch arena untuk perintah shell.
+#include "sysclk.h" // Frekuensi clock sistem (PLL).
+#include "systick.h" // Timebase monotonic dan profil boot.
+#include "nvic.h"   // Driver NVIC dan pengukuran latensi interrupt.
+#include "sched.h"  // Scheduler preemptive; shell berjalan sebagai task.
+#include "jobs.h"   // Background job (coroutine) untuk perintah dengan akhiran '&'.
+#include "timer.h"  // Software timer (timing wheel) di atas Timer0.
+#include "tickless.h" // Idle tickless: tick SysTick ditahan saat core tidur.
+#include "sync.h"   // Mutex, semaphore dan event flags (heap dilindungi mutex).
+#include "workq.h"  // Deferred work (bottom half) untuk ISR.
+#include "mbox.h"   // Mailbox: IPC zero-copy (pointer buffer pool) antar task.
+#include "shell.h"  // Tabel perintah shell, tokenizer argc/argv.
+#include "kprintf.h" // kprintf/ksnprintf: satu baris diformat lalu dikirim sekaligus.
+#include "log.h"    // Log per subsistem; level di-compile out atau diatur lewat 'loglevel'.
+#include "trace.h"  // Trace event biner di RAM, perintah 'trace'.
 
 // Definisi karakter kontrol umum
 #define ASCII_CR    0x0D // Carriage Return (Enter)
@@ -8,12 +25,26 @@
 #define ASCII_BS    0x08 // Backspace
 #define ASCII_DEL   0x7F // Delete
 
+// Baud rate UART0; pembaginya dihitung dari clock sistem saat runtime
+#define UART0_BAUD_RATE 115200
+
 // Ukuran buffer untuk input baris
 #define MAX_LINE_LENGTH 128
 
+// Ukuran scratch arena per perintah. Semua alokasinya dibuang saat kembali ke prompt.
+#define SCRATCH_ARENA_SIZE 1024
+
+// Task shell: prioritas menengah agar task prioritas tinggi (driver) tetap bisa mendahului
+#define SHELL_TASK_PRIORITY 8
+#define SHELL_STACK_SIZE    2048
+
 // String pesan yang akan ditampilkan.
 static char greet[] = "Welcome to Amadeus OS v0.7.5! ^_^\n";
 
+// Scratch arena untuk buffer sementara perintah shell (parsing, format angka, dll.)
+static uint8_t scratch_mem[SCRATCH_ARENA_SIZE] __attribute__((aligned(8)));
+static Arena scratch;
+
 // ============================================================================
 // Deklarasi Eksternal dari Linker Script untuk Heap
 // ============================================================================
@@ -34,89 +65,290 @@ void readline(char *buffer, int max_len);
 int atoi(const char *s, const char **endptr);
 void itoa(int n, char *s);
 void uart0_init(void);
+void uart0_irq_init(void);
+void uart0_set_baud(uint32_t baud);
+void uart0_flush(void);
+void uart0_set_tx_policy(int drop);
+int uart0_tx_stats(uint32_t *queued, uint32_t *dropped);
+void uart0_rx_stats(uint32_t *buffered, uint32_t *dropped, uint32_t *overruns);
 
 // Helper function prototypes
 void* memset(void *s, int c, size_t n);
 void* memcpy(void *dest, const void *src, size_t n);
+void* memmove(void *dest, const void *src, size_t n);
+int memcmp(const void *s1, const void *s2, size_t n);
+void* memset32(void *s, uint32_t value, size_t count);
+void mem_bench(void);
 void print_hex(uint32_t n);
 uint32_t htoi(const char *s, const char **endptr);
 void panic(const char* message);
 
 // Deklarasi Prototype untuk Heap Manager
 void malloc_init(void);
+int heap_add_region(void* start, size_t size);
 void* malloc(size_t size);
 void free(void* ptr);
 void* calloc(size_t num, size_t size);
 void* realloc(void* ptr, size_t new_size);
 void print_heap_map(void);
+void heap_bench(void);
 
 
 // ============================================================================
 // Implementasi Heap Manager (malloc/free/calloc/realloc)
 // ============================================================================
+//
+// Allocator segregated-fit: setiap blok bebas dimasukkan ke salah satu free
+// list berdasarkan kelas ukurannya. Pointer next/prev disimpan di dalam
+// payload blok bebas itu sendiri, jadi tidak ada memori tambahan. Sebuah
+// bitmap menandai kelas mana yang tidak kosong sehingga kelas terdekat yang
+// cukup besar ditemukan dengan satu instruksi CTZ, bukan dengan menelusuri
+// seluruh heap.
+//
+// Setiap header juga menyimpan ukuran blok sebelumnya (boundary tag), sehingga
+// free() menemukan kedua tetangganya dalam O(1) tanpa menelusuri heap dari awal.
+//
+// Heap bisa terdiri dari beberapa region RAM yang tidak bersebelahan (lihat
+// heap_add_region). Setiap region diakhiri header sentinel berukuran 0 yang
+// selalu berstatus terpakai, sehingga blok tidak pernah digabung melewati
+// batas region dan penelusuran berhenti di sana.
 
 #define HEAP_MAGIC 0xCAFEBABE // Magic number untuk validasi blok
 
 typedef struct BlockHeader {
+    size_t prev_size; // Ukuran blok fisik sebelumnya, 0 untuk blok pertama
     size_t size;
     int free;
     uint32_t magic; // Magic number untuk validasi
 } BlockHeader;
 
+// Link free list, hanya valid selama blok berstatus bebas (menempati payload).
+typedef struct FreeLinks {
+    BlockHeader* next;
+    BlockHeader* prev;
+} FreeLinks;
+
 #define ALIGN_SIZE(size) (((size) + (sizeof(uint32_t) - 1)) & ~(sizeof(uint32_t) - 1))
-#define MIN_BLOCK_SIZE   (ALIGN_SIZE(sizeof(BlockHeader)))
+#define MIN_BLOCK_SIZE   (ALIGN_SIZE(sizeof(BlockHeader) + sizeof(FreeLinks)))
 
-void malloc_init(void) {
-    BlockHeader* head = (BlockHeader*)&__heap_start__;
-    head->size = (uint32_t)&__heap_end__ - (uint32_t)&__heap_start__;
-    head->free = 1;
-    head->magic = 0; // Blok awal tidak memiliki magic number
+// Kelas ukuran: 16 kelas "kecil" selebar 16 byte untuk blok < 256 byte,
+// lalu satu kelas per pangkat dua untuk blok yang lebih besar.
+#define HEAP_SMALL_LIMIT   256
+#define HEAP_SMALL_SHIFT   4
+#define HEAP_NUM_SMALL     (HEAP_SMALL_LIMIT >> HEAP_SMALL_SHIFT)
+#define HEAP_NUM_CLASSES   32
+
+#define FREE_LINKS(block) ((FreeLinks*)((uint8_t*)(block) + sizeof(BlockHeader)))
+
+#define HEAP_MAX_REGIONS   4
+
+typedef struct HeapRegion {
+    uint8_t* start;       // Blok pertama region
+    uint8_t* end;         // Header sentinel di akhir region
+} HeapRegion;
+
+static HeapRegion heap_regions[HEAP_MAX_REGIONS];
+static int heap_region_count;
+
+static BlockHeader* free_lists[HEAP_NUM_CLASSES];
+static uint32_t free_bitmap;      // Bit n = 1 jika free_lists[n] tidak kosong
+static uint32_t heap_probe_count; // Jumlah header yang diperiksa malloc (untuk heapbench)
+static Mutex heap_lock;           // Melindungi seluruh state heap antar task
+
+// Blok fisik berikutnya, atau NULL jika `block` adalah blok terakhir di region-nya.
+static BlockHeader* heap_next_block(BlockHeader* block) {
+    BlockHeader* next = (BlockHeader*)((uint8_t*)block + block->size);
+    return (next->size != 0) ? next : NULL;
 }
 
-void* malloc(size_t size) {
-    if (size == 0) return NULL;
+// Blok fisik sebelumnya via boundary tag, atau NULL untuk blok pertama.
+static BlockHeader* heap_prev_block(BlockHeader* block) {
+    return block->prev_size ? (BlockHeader*)((uint8_t*)block - block->prev_size) : NULL;
+}
+
+// Mengubah ukuran blok sekaligus memperbarui boundary tag di blok berikutnya
+// (termasuk sentinel akhir region).
+static void heap_set_size(BlockHeader* block, size_t size) {
+    block->size = size;
+    BlockHeader* next = (BlockHeader*)((uint8_t*)block + size);
+    next->prev_size = size;
+}
+
+// Menghapus header blok yang sudah diserap oleh tetangganya, agar tidak ada
+// header basi (free = 1) yang tertinggal di tengah blok hasil penggabungan.
+static void heap_scrub_header(BlockHeader* block) {
+    block->prev_size = 0;
+    block->size = 0;
+    block->free = 0;
+    block->magic = 0;
+}
+
+static int heap_size_class(size_t size) {
+    if (size < HEAP_SMALL_LIMIT) {
+        return size >> HEAP_SMALL_SHIFT;
+    }
+    // 256..511 -> kelas 16, 512..1023 -> kelas 17, dst.
+    int cls = HEAP_NUM_SMALL + (31 - __builtin_clz(size)) - 8;
+    return cls < HEAP_NUM_CLASSES ? cls : HEAP_NUM_CLASSES - 1;
+}
+
+static void free_list_insert(BlockHeader* block) {
+    int cls = heap_size_class(block->size);
+    FreeLinks* links = FREE_LINKS(block);
+    links->prev = NULL;
+    links->next = free_lists[cls];
+    if (free_lists[cls] != NULL) {
+        FREE_LINKS(free_lists[cls])->prev = block;
+    }
+    free_lists[cls] = block;
+    free_bitmap |= (1u << cls);
+}
+
+static void free_list_remove(BlockHeader* block) {
+    int cls = heap_size_class(block->size);
+    FreeLinks* links = FREE_LINKS(block);
+    if (links->prev != NULL) {
+        FREE_LINKS(links->prev)->next = links->next;
+    } else {
+        free_lists[cls] = links->next;
+    }
+    if (links->next != NULL) {
+        FREE_LINKS(links->next)->prev = links->prev;
+    }
+    if (free_lists[cls] == NULL) {
+        free_bitmap &= ~(1u << cls);
+    }
+}
+
+// Mencari blok bebas >= required_size. Kelas milik request diperiksa first-fit
+// (isinya bisa lebih kecil dari request), kelas di atasnya pasti cukup besar
+// sehingga kepala list-nya langsung dipakai.
+static BlockHeader* free_list_find(size_t required_size) {
+    int cls = heap_size_class(required_size);
+
+    for (BlockHeader* b = free_lists[cls]; b != NULL; b = FREE_LINKS(b)->next) {
+        heap_probe_count++;
+        if (b->size >= required_size) {
+            return b;
+        }
+    }
+
+    uint32_t larger = (cls + 1 < HEAP_NUM_CLASSES) ? (free_bitmap & ~((2u << cls) - 1)) : 0;
+    if (larger == 0) {
+        return NULL;
+    }
+    heap_probe_count++;
+    return free_lists[__builtin_ctz(larger)];
+}
 
+// Ukuran blok (termasuk header) yang dibutuhkan untuk payload `size` byte.
+static size_t heap_required_size(size_t size) {
     size_t required_size = ALIGN_SIZE(size + sizeof(BlockHeader));
-    if (required_size < MIN_BLOCK_SIZE) {
-        required_size = MIN_BLOCK_SIZE;
+    return required_size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : required_size;
+}
+
+static void heap_release(BlockHeader* block_to_free);
+
+// Memotong blok terpakai menjadi `required_size` byte jika sisanya cukup besar
+// untuk menjadi blok sendiri. Sisa itu dibebaskan lewat heap_release() sehingga
+// langsung bergabung dengan tetangga kanan yang bebas.
+static void heap_split(BlockHeader* block, size_t required_size) {
+    if (block->size - required_size < MIN_BLOCK_SIZE) {
+        return;
     }
+    BlockHeader* tail = (BlockHeader*)((uint8_t*)block + required_size);
+    tail->prev_size = required_size;
+    tail->free = 0;
+    tail->magic = HEAP_MAGIC;
+    heap_set_size(tail, block->size - required_size);
+    block->size = required_size;
+    heap_release(tail);
+}
 
-    BlockHeader* current = (BlockHeader*)&__heap_start__;
-    BlockHeader* best_fit = NULL;
+// Menambahkan satu region RAM ke heap. Bisa dipanggil beberapa kali untuk
+// blok RAM yang tidak bersebelahan. Mengembalikan 0 jika berhasil.
+int heap_add_region(void* start, size_t size) {
+    uint32_t first = ((uint32_t)start + 7) & ~7u;
+    uint32_t last = ((uint32_t)start + size) & ~3u;
 
-    while((uint32_t)current < (uint32_t)&__heap_end__ && current->size > 0) {
-        if (current->free && current->size >= required_size) {
-            if (best_fit == NULL || current->size < best_fit->size) {
-                 best_fit = current;
-            }
+    if (heap_region_count >= HEAP_MAX_REGIONS || last < first ||
+        last - first < MIN_BLOCK_SIZE + sizeof(BlockHeader)) {
+        return -1;
+    }
+
+    BlockHeader* sentinel = (BlockHeader*)(last - sizeof(BlockHeader));
+    sentinel->size = 0;
+    sentinel->free = 0;
+    sentinel->magic = 0;
+
+    BlockHeader* head = (BlockHeader*)first;
+    head->prev_size = 0;
+    head->free = 1;
+    head->magic = 0; // Blok awal tidak memiliki magic number
+    heap_set_size(head, (uint32_t)sentinel - first);
+
+    heap_regions[heap_region_count].start = (uint8_t*)head;
+    heap_regions[heap_region_count].end = (uint8_t*)sentinel;
+    heap_region_count++;
+
+    free_list_insert(head);
+    return 0;
+}
+
+// Region tempat `ptr` berada, atau NULL jika di luar heap.
+static HeapRegion* heap_find_region(void* ptr) {
+    for (int i = 0; i < heap_region_count; i++) {
+        if ((uint8_t*)ptr >= heap_regions[i].start && (uint8_t*)ptr < heap_regions[i].end) {
+            return &heap_regions[i];
         }
-        current = (BlockHeader*)((uint8_t*)current + current->size);
     }
-    
-    current = best_fit;
+    return NULL;
+}
+
+void malloc_init(void) {
+    for (int i = 0; i < HEAP_NUM_CLASSES; i++) {
+        free_lists[i] = NULL;
+    }
+    free_bitmap = 0;
+    heap_region_count = 0;
+    mutex_init(&heap_lock, "heap");
+
+    // Region utama: seluruh RAM antara akhir .bss dan reservasi stack (hello.ld)
+    heap_add_region(&__heap_start__, (uint32_t)&__heap_end__ - (uint32_t)&__heap_start__);
+}
+
+// Implementasi malloc tanpa lock; pemanggil memegang heap_lock.
+static void* heap_alloc(size_t size) {
+    if (size == 0) return NULL;
+
+    size_t required_size = heap_required_size(size);
+    BlockHeader* current = free_list_find(required_size);
 
     if (current != NULL) {
-        if (current->size - required_size >= MIN_BLOCK_SIZE) {
-            BlockHeader* new_block = (BlockHeader*)((uint8_t*)current + required_size);
-            new_block->size = current->size - required_size;
-            new_block->free = 1;
-            new_block->magic = 0; // Blok bebas baru tidak punya magic
-            current->size = required_size;
-        }
+        free_list_remove(current);
         current->free = 0;
         current->magic = HEAP_MAGIC; // Set magic number saat alokasi
+        heap_split(current, required_size);
         return (void*)((uint8_t*)current + sizeof(BlockHeader));
     }
     return NULL;
 }
 
+void* malloc(size_t size) {
+    mutex_lock(&heap_lock);
+    void* ptr = heap_alloc(size);
+    mutex_unlock(&heap_lock);
+    TRACE(TRACE_EV_MALLOC, size, ptr);
+    return ptr;
+}
 
-void free(void* ptr) {
+// Implementasi free tanpa lock; pemanggil memegang heap_lock.
+static void heap_free(void* ptr) {
     if (ptr == NULL) return;
 
-    // Cek apakah pointer berada di dalam rentang heap
-    if ((uint32_t)ptr < (uint32_t)&__heap_start__ + sizeof(BlockHeader) || (uint32_t)ptr >= (uint32_t)&__heap_end__) {
-        print_str("Error: Address is outside of heap boundary!\n");
+    // Cek apakah pointer berada di dalam salah satu region heap
+    if (heap_find_region((uint8_t*)ptr - sizeof(BlockHeader)) == NULL) {
+        LOG_ERROR(HEAP, "Address %p is outside of heap boundary!\n", ptr);
         return;
     }
 
@@ -124,41 +356,132 @@ void free(void* ptr) {
 
     // Validasi magic number
     if (block_to_free->magic != HEAP_MAGIC) {
-        print_str("Error: Invalid pointer or heap corruption detected!\n");
+        LOG_ERROR(HEAP, "Invalid pointer %p or heap corruption detected!\n", ptr);
         // Di OS nyata, ini bisa memicu panic()
         // panic("Heap corruption detected in free()");
         return;
     }
 
     if (block_to_free->free) {
-        print_str("Warning: Double-free detected!\n");
+        LOG_WARN(HEAP, "Double-free of %p detected!\n", ptr);
         return;
     }
 
+    heap_release(block_to_free);
+    LOG_DEBUG(HEAP, "Freed memory at %p\n", ptr);
+}
+
+void free(void* ptr) {
+    TRACE(TRACE_EV_FREE, ptr, 0);
+    mutex_lock(&heap_lock);
+    heap_free(ptr);
+    mutex_unlock(&heap_lock);
+}
+
+// Menandai blok sebagai bebas, menggabungkannya dengan tetangga yang bebas,
+// lalu memasukkannya ke free list. Pemanggil sudah memvalidasi bloknya.
+static void heap_release(BlockHeader* block_to_free) {
     block_to_free->free = 1;
     block_to_free->magic = 0; // Hapus magic number saat dibebaskan
-    print_str("Freed memory at "); print_hex((uint32_t)ptr); print_str("\n");
 
     // Coalesce forward
-    BlockHeader* next_block = (BlockHeader*)((uint8_t*)block_to_free + block_to_free->size);
-    if ((uint32_t)next_block < (uint32_t)&__heap_end__ && next_block->free) {
-        block_to_free->size += next_block->size;
+    BlockHeader* next_block = heap_next_block(block_to_free);
+    if (next_block != NULL && next_block->free) {
+        free_list_remove(next_block);
+        heap_set_size(block_to_free, block_to_free->size + next_block->size);
+        heap_scrub_header(next_block);
     }
-    
-    // Coalesce backward
-    BlockHeader* current = (BlockHeader*)&__heap_start__;
-    while((uint32_t)current < (uint32_t)block_to_free) {
-        BlockHeader* next = (BlockHeader*)((uint8_t*)current + current->size);
-        if ((uint32_t)next == (uint32_t)block_to_free) {
-             if(current->free){
-                current->size += block_to_free->size;
-                // Setelah digabung, `block_to_free` menjadi tidak relevan,
-                // tapi memorinya sudah menjadi bagian dari `current`.
-             }
-             break;
+
+    // Coalesce backward, tetangga kiri ditemukan lewat boundary tag
+    BlockHeader* prev_block = heap_prev_block(block_to_free);
+    if (prev_block != NULL && prev_block->free) {
+        free_list_remove(prev_block);
+        heap_set_size(prev_block, prev_block->size + block_to_free->size);
+        heap_scrub_header(block_to_free);
+        block_to_free = prev_block;
+    }
+
+    free_list_insert(block_to_free);
+}
+
+// Menghitung berapa header yang akan diperiksa oleh allocator best-fit lama
+// (scan linear seluruh heap) untuk request yang sama. Hanya untuk heapbench.
+static uint32_t heap_bestfit_probes(size_t required_size, BlockHeader** best) {
+    uint32_t probes = 0;
+    *best = NULL;
+    for (int i = 0; i < heap_region_count; i++) {
+        BlockHeader* current = (BlockHeader*)heap_regions[i].start;
+        for (; current != NULL; current = heap_next_block(current)) {
+            probes++;
+            if (current->free && current->size >= required_size) {
+                if (*best == NULL || current->size < (*best)->size) {
+                    *best = current;
+                }
+            }
         }
-        current = next;
     }
+    return probes;
+}
+
+// Benchmark heapbench: membuat heap terfragmentasi (blok kecil berselang-seling
+// bebas/terpakai), lalu membandingkan jumlah header yang diperiksa oleh scan
+// best-fit lama dengan pencarian free list segregated untuk request yang sama.
+#define HEAP_BENCH_BLOCKS 64
+#define HEAP_BENCH_ALLOCS (HEAP_BENCH_BLOCKS / 2)
+
+void heap_bench(void) {
+    void* blocks[HEAP_BENCH_BLOCKS];
+    uint32_t bf_total = 0, bf_max = 0, seg_total = 0, seg_max = 0;
+    int n = 0;
+
+    mutex_lock(&heap_lock);
+
+    for (int i = 0; i < HEAP_BENCH_BLOCKS; i++) {
+        blocks[i] = heap_alloc(8 + (i * 37) % 120);
+    }
+    // Bebaskan setiap blok genap agar terbentuk lubang-lubang kecil
+    for (int i = 0; i < HEAP_BENCH_BLOCKS; i += 2) {
+        if (blocks[i] != NULL) {
+            heap_release((BlockHeader*)((uint8_t*)blocks[i] - sizeof(BlockHeader)));
+            blocks[i] = NULL;
+        }
+    }
+
+    for (int j = 0; j < HEAP_BENCH_ALLOCS; j++) {
+        size_t size = 8 + (j * 53) % 200;
+        size_t required_size = heap_required_size(size);
+
+        BlockHeader* best;
+        uint32_t bf = heap_bestfit_probes(required_size, &best);
+
+        heap_probe_count = 0;
+        blocks[2 * j] = heap_alloc(size);
+        uint32_t seg = heap_probe_count;
+
+        if (blocks[2 * j] == NULL) break;
+        bf_total += bf;
+        seg_total += seg;
+        if (bf > bf_max) bf_max = bf;
+        if (seg > seg_max) seg_max = seg;
+        n++;
+    }
+
+    for (int i = 0; i < HEAP_BENCH_BLOCKS; i++) {
+        if (blocks[i] != NULL) {
+            heap_release((BlockHeader*)((uint8_t*)blocks[i] - sizeof(BlockHeader)));
+        }
+    }
+
+    mutex_unlock(&heap_lock);
+
+    if (n == 0) {
+        print_str("heapbench: not enough free heap\n");
+        return;
+    }
+    kprintf("Fragmented heap, %d allocations (headers inspected per malloc):\n"
+            "  best-fit scan:  avg %u | max %u\n"
+            "  segregated fit: avg %u | max %u\n",
+            n, bf_total / n, bf_max, seg_total / n, seg_max);
 }
 
 void* calloc(size_t num, size_t size) {
@@ -171,101 +494,287 @@ void* calloc(size_t num, size_t size) {
     return ptr;
 }
 
-void* realloc(void* ptr, size_t new_size) {
-    if (ptr == NULL) return malloc(new_size);
+// Implementasi realloc tanpa lock; pemanggil memegang heap_lock.
+static void* heap_realloc(void* ptr, size_t new_size) {
+    if (ptr == NULL) return heap_alloc(new_size);
     if (new_size == 0) {
-        free(ptr);
+        heap_free(ptr);
         return NULL;
     }
     
     // Validasi magic number sebelum realloc
     BlockHeader* old_header = (BlockHeader*)((uint8_t*)ptr - sizeof(BlockHeader));
     if (old_header->magic != HEAP_MAGIC) {
-        print_str("Error: Invalid pointer passed to realloc()!\n");
+        LOG_ERROR(HEAP, "Invalid pointer %p passed to realloc()!\n", ptr);
         return NULL;
     }
 
-    size_t old_size = old_header->size - sizeof(BlockHeader);
+    size_t required_size = heap_required_size(new_size);
 
-    if (new_size <= old_size) return ptr;
+    // Mengecil (atau masih muat): potong ekornya dan kembalikan ke heap
+    if (required_size <= old_header->size) {
+        heap_split(old_header, required_size);
+        return ptr;
+    }
+
+    // Membesar: serap blok kanan jika bebas dan cukup besar, tanpa menyalin data
+    BlockHeader* next_block = heap_next_block(old_header);
+    if (next_block != NULL && next_block->free &&
+        old_header->size + next_block->size >= required_size) {
+        free_list_remove(next_block);
+        heap_set_size(old_header, old_header->size + next_block->size);
+        heap_scrub_header(next_block);
+        heap_split(old_header, required_size);
+        return ptr;
+    }
 
-    void* new_ptr = malloc(new_size);
+    // Jalan terakhir: pindahkan ke blok baru
+    size_t old_size = old_header->size - sizeof(BlockHeader);
+    void* new_ptr = heap_alloc(new_size);
     if (new_ptr == NULL) return NULL;
 
     memcpy(new_ptr, ptr, old_size);
-    free(ptr);
+    heap_free(ptr);
+    return new_ptr;
+}
+
+void* realloc(void* ptr, size_t new_size) {
+    mutex_lock(&heap_lock);
+    void* new_ptr = heap_realloc(ptr, new_size);
+    mutex_unlock(&heap_lock);
+    TRACE(TRACE_EV_REALLOC, ptr, new_ptr);
     return new_ptr;
 }
 
 void print_heap_map(void) {
     const int MAP_WIDTH = 40;
-    size_t total_heap_size = (uint32_t)&__heap_end__ - (uint32_t)&__heap_start__;
+    size_t total_heap_size = 0;
+    for (int r = 0; r < heap_region_count; r++) {
+        total_heap_size += heap_regions[r].end - heap_regions[r].start;
+    }
     
     print_str("Heap Map:\n[");
+    mutex_lock(&heap_lock);
 
-    BlockHeader* current = (BlockHeader*)&__heap_start__;
-    while((uint32_t)current < (uint32_t)&__heap_end__ && current->size > 0) {
-        int chars = (current->size * MAP_WIDTH) / total_heap_size;
-        if (chars == 0) chars = 1;
-        
-        char block_char = current->free ? '-' : '#';
-        for (int i = 0; i < chars; i++) {
-            uart0_putc(block_char);
+    for (int r = 0; r < heap_region_count; r++) {
+        if (r > 0) uart0_putc('|'); // Batas antar region
+        BlockHeader* current = (BlockHeader*)heap_regions[r].start;
+        size_t prev_size = 0;
+        while (current != NULL && current->size > 0) {
+            int chars = (current->size * MAP_WIDTH) / total_heap_size;
+            if (chars == 0) chars = 1;
+            
+            // '!' menandai blok yang boundary tag-nya tidak cocok (heap korup)
+            char block_char = (current->prev_size != prev_size) ? '!' : (current->free ? '-' : '#');
+            for (int i = 0; i < chars; i++) {
+                uart0_putc(block_char);
+            }
+            
+            prev_size = current->size;
+            current = heap_next_block(current);
         }
-        
-        current = (BlockHeader*)((uint8_t*)current + current->size);
     }
     
+    mutex_unlock(&heap_lock);
     print_str("]\n");
-    print_str("# = Allocated, - = Free\n");
+    print_str("# = Allocated, - = Free, ! = Corrupt boundary tag\n");
 }
 
 // ============================================================================
 // Implementasi Fungsi Helper
 // ============================================================================
 void panic(const char* message) {
+    // Matikan interrupt: UART otomatis kembali ke jalur polling (blocking),
+    // sisa isi TX ring dikirim dulu sebelum pesan panic.
+    irq_save();
     print_str("\n*** KERNEL PANIC ***\n");
     print_str(message);
     print_str("\nSystem halted.\n");
     while(1); // Halt the system
 }
 
-void* memset(void *s, int c, size_t n) {
+// Akses word yang boleh tidak aligned. Cortex-M3 mendukung LDR/STR unaligned
+// (bukan LDM/STM), jadi ini dipakai saat alignment src dan dest berbeda.
+typedef uint32_t __attribute__((aligned(1))) unaligned_u32;
+
+// Mengisi `words` word mulai dari `p` (harus aligned 4) dengan `pattern`.
+// Blok besar ditulis 16 byte sekaligus dengan satu STM.
+RAMFUNC static uint32_t* fill_words(uint32_t* p, uint32_t pattern, size_t words) {
+    while (words >= 4) {
+        __asm__ volatile (
+            "mov r3, %1\n\t"
+            "mov r4, %1\n\t"
+            "mov r5, %1\n\t"
+            "mov r6, %1\n\t"
+            "stmia %0!, {r3, r4, r5, r6}"
+            : "+r" (p) : "r" (pattern) : "r3", "r4", "r5", "r6", "memory");
+        words -= 4;
+    }
+    while (words--) *p++ = pattern;
+    return p;
+}
+
+RAMFUNC void* memset(void *s, int c, size_t n) {
     unsigned char *p = s;
+    // Bagian kepala byte per byte sampai alamat aligned 4
+    while (n && ((uint32_t)p & 3)) {
+        *p++ = (unsigned char)c;
+        n--;
+    }
+    // Badan per word (STM burst), lalu sisa ekor byte per byte
+    uint32_t pattern = (unsigned char)c * 0x01010101u;
+    p = (unsigned char*)fill_words((uint32_t*)p, pattern, n >> 2);
+    n &= 3;
     while (n--) *p++ = (unsigned char)c;
     return s;
 }
 
-void* memcpy(void *dest, const void *src, size_t n) {
+// Mengisi `count` word mulai dari `s` (harus aligned 4) dengan nilai 32-bit.
+// Dipakai oleh perintah 'fill' mode word.
+void* memset32(void *s, uint32_t value, size_t count) {
+    fill_words((uint32_t*)s, value, count);
+    return s;
+}
+
+RAMFUNC void* memcpy(void *dest, const void *src, size_t n) {
     char *d = dest;
     const char *s = src;
+
+    if ((((uint32_t)d ^ (uint32_t)s) & 3) == 0) {
+        // Alignment sama: samakan ke batas word, lalu salin 16 byte per LDM/STM
+        while (n && ((uint32_t)d & 3)) {
+            *d++ = *s++;
+            n--;
+        }
+        while (n >= 16) {
+            __asm__ volatile (
+                "ldmia %1!, {r3, r4, r5, r6}\n\t"
+                "stmia %0!, {r3, r4, r5, r6}"
+                : "+r" (d), "+r" (s) :: "r3", "r4", "r5", "r6", "memory");
+            n -= 16;
+        }
+        while (n >= 4) {
+            *(uint32_t*)d = *(const uint32_t*)s;
+            d += 4; s += 4; n -= 4;
+        }
+    } else if (n >= 8) {
+        // Alignment berbeda: tulis aligned ke dest, baca unaligned dari src
+        while ((uint32_t)d & 3) {
+            *d++ = *s++;
+            n--;
+        }
+        while (n >= 4) {
+            *(uint32_t*)d = *(const unaligned_u32*)s;
+            d += 4; s += 4; n -= 4;
+        }
+    }
     while (n--) *d++ = *s++;
     return dest;
 }
 
-void print_hex(uint32_t n) {
-    char buffer[9]; // 8 hex digits + null terminator
-    char *ptr = &buffer[8];
-    *ptr = '\0';
-    ptr--;
-    
-    if (n == 0) {
-        print_str("0x0");
-        return;
+void* memmove(void *dest, const void *src, size_t n) {
+    // memcpy menyalin maju, aman selama dest berada sebelum src
+    if ((uint32_t)dest <= (uint32_t)src || (uint32_t)dest >= (uint32_t)src + n) {
+        return memcpy(dest, src, n);
     }
-    
-    print_str("0x");
-    while (n > 0) {
-        uint8_t digit = n % 16;
-        if (digit < 10) {
-            *ptr-- = '0' + digit;
-        } else {
-            *ptr-- = 'a' + (digit - 10);
+
+    // Overlap dengan dest di belakang src: salin mundur
+    char *d = (char*)dest + n;
+    const char *s = (const char*)src + n;
+    if ((((uint32_t)d ^ (uint32_t)s) & 3) == 0) {
+        while (n && ((uint32_t)d & 3)) {
+            *--d = *--s;
+            n--;
+        }
+        while (n >= 4) {
+            d -= 4; s -= 4; n -= 4;
+            *(uint32_t*)d = *(const uint32_t*)s;
         }
-        n /= 16;
     }
-    
-    print_str(ptr + 1);
+    while (n--) *--d = *--s;
+    return dest;
+}
+
+int memcmp(const void *s1, const void *s2, size_t n) {
+    const unsigned char *a = s1;
+    const unsigned char *b = s2;
+
+    if ((((uint32_t)a ^ (uint32_t)b) & 3) == 0) {
+        while (n && ((uint32_t)a & 3)) {
+            if (*a != *b) return *a - *b;
+            a++; b++; n--;
+        }
+        // Lewati word yang sama; word pertama yang berbeda dibandingkan per byte
+        while (n >= 4 && *(const uint32_t*)a == *(const uint32_t*)b) {
+            a += 4; b += 4; n -= 4;
+        }
+    }
+    while (n--) {
+        if (*a != *b) return *a - *b;
+        a++; b++;
+    }
+    return 0;
+}
+
+// Benchmark membench: membandingkan loop byte-per-byte lama dengan jalur word/
+// LDM/STM untuk memcpy dan memset. Waktu diukur dengan time_cycles() (SysTick),
+// jadi hasilnya dalam cycle CPU.
+#define MEM_BENCH_BYTES 2048
+
+static uint32_t bench_elapsed(uint64_t start) {
+    return (uint32_t)(time_cycles() - start);
+}
+
+static void memcpy_bytewise(void *dest, const void *src, size_t n) {
+    volatile char *d = dest;
+    const char *s = src;
+    while (n--) *d++ = *s++;
+}
+
+static void memset_bytewise(void *s, int c, size_t n) {
+    volatile unsigned char *p = s;
+    while (n--) *p++ = (unsigned char)c;
+}
+
+// Mencetak rasio byte/cycle dengan dua angka desimal
+static void print_rate(const char *label, uint32_t cycles) {
+    if (cycles == 0) cycles = 1;
+    uint32_t centi = (MEM_BENCH_BYTES * 100) / cycles;
+    kprintf("%s%u cycles | %u.%02u bytes/cycle\n", label, cycles, centi / 100, centi % 100);
+}
+
+void mem_bench(void) {
+    uint8_t *src = malloc(MEM_BENCH_BYTES);
+    uint8_t *dst = malloc(MEM_BENCH_BYTES);
+    if (src == NULL || dst == NULL) {
+        print_str("membench: not enough free heap\n");
+        free(src);
+        free(dst);
+        return;
+    }
+
+    kprintf("memcpy (%u bytes, aligned):\n", MEM_BENCH_BYTES);
+    uint64_t t = time_cycles();
+    memcpy_bytewise(dst, src, MEM_BENCH_BYTES);
+    print_rate("  byte loop: ", bench_elapsed(t));
+    t = time_cycles();
+    memcpy(dst, src, MEM_BENCH_BYTES);
+    print_rate("  word/LDM:  ", bench_elapsed(t));
+
+    kprintf("memset (%u bytes, aligned):\n", MEM_BENCH_BYTES);
+    t = time_cycles();
+    memset_bytewise(dst, 0x5A, MEM_BENCH_BYTES);
+    print_rate("  byte loop: ", bench_elapsed(t));
+    t = time_cycles();
+    memset(dst, 0x5A, MEM_BENCH_BYTES);
+    print_rate("  word/STM:  ", bench_elapsed(t));
+
+    free(src);
+    free(dst);
+}
+
+void print_hex(uint32_t n) {
+    kprintf("0x%x", n);
 }
 
 uint32_t htoi(const char *s, const char **endptr) {
@@ -299,183 +808,456 @@ void uart0_init(void) {
     *(GPIOA_PCTL) &= ~0x000000FF;
     *(GPIOA_PCTL) |= 0x00000011;
     *(GPIOA_DEN) |= ((1 << 0) | (1 << 1));
-    *(UART0_IBRD) = 27;
-    *(UART0_FBRD) = 8;
+    uart0_set_baud(UART0_BAUD_RATE);
     *(UART0_LCRH) = (UART0_LCRH_WLEN_8 | UART0_LCRH_FEN);
     *(UART0_CTL) = (UART0_CTL_UARTEN | UART0_CTL_TXE | UART0_CTL_RXE);
+    uart0_irq_init();
 }
 
-void main(void) {
-    char line_buffer[MAX_LINE_LENGTH];
-    char temp_str[32];
-
-    uart0_init();
-    malloc_init();
+// ============================================================================
+// Perintah Shell
+// ============================================================================
+//
+// Setiap perintah adalah handler di tabel shell_commands (urut nama, lihat
+// shell.h). Argumen angka sudah divalidasi oleh shell; handler hanya memeriksa
+// apakah nilainya masuk akal dan mengembalikan -1 agar usage dicetak.
 
-    print_str(greet);
+static int shell_exit; // Diset oleh 'exit'
 
-    while (1) {
-        print_str("AmadeusOS> ");
-        readline(line_buffer, MAX_LINE_LENGTH);
+static int cmd_help(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    print_str("Available commands:\n");
+    shell_print_help();
+    jobs_print_help();
+    return 0;
+}
 
-        char command_name[16];
-        const char *args_ptr = line_buffer;
+static int cmd_clear(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    clear_screen();
+    return 0;
+}
 
-        while (*args_ptr == ' ') args_ptr++;
+static int cmd_echo(int argc, const ShellArg *argv) {
+    if (argc > 1) print_str(argv[1].str);
+    print_str("\n");
+    return 0;
+}
 
-        int i = 0;
-        while (args_ptr[i] != ' ' && args_ptr[i] != '\0' && i < 15) {
-            if (args_ptr[i] >= 'A' && args_ptr[i] <= 'Z') {
-                command_name[i] = args_ptr[i] + ('a' - 'A');
+static int cmd_meminfo(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    print_str("Heap Information:\n");
+    // Tahan heap_lock selama walk: kprintf bisa tidur menunggu UART, dan
+    // task lain tidak boleh memecah/menggabung blok yang sedang dicetak.
+    mutex_lock(&heap_lock);
+    for (int r = 0; r < heap_region_count; r++) {
+        kprintf("  Region %d: %p - %p (%u bytes)\n", r, heap_regions[r].start, heap_regions[r].end,
+                (uint32_t)(heap_regions[r].end - heap_regions[r].start));
+        BlockHeader* current = (BlockHeader*)heap_regions[r].start;
+        size_t prev_size = 0;
+        while (current != NULL && current->size > 0) {
+            // Satu kprintf per blok: baris dikirim ke UART sekaligus.
+            if (current->free) {
+                kprintf("  Block at %p | Size: %u | Prev: %u | Free: Yes%s\n",
+                        current, current->size, current->prev_size,
+                        current->prev_size != prev_size ? " | BAD TAG" : "");
             } else {
-                command_name[i] = args_ptr[i];
+                kprintf("  Block at %p | Size: %u | Prev: %u | Free: No | Magic: %p%s\n",
+                        current, current->size, current->prev_size, (void*)current->magic,
+                        current->prev_size != prev_size ? " | BAD TAG" : "");
             }
-            i++;
+            prev_size = current->size;
+            current = heap_next_block(current);
+        }
+    }
+    mutex_unlock(&heap_lock);
+    kprintf("Scratch Arena:\n  Size: %u | In use: %u | High water: %u | Fails: %u\n",
+            scratch.size, scratch.used, scratch.high_water, scratch.fails);
+    return 0;
+}
+
+static int cmd_heapmap(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    print_heap_map();
+    return 0;
+}
+
+static int cmd_heapbench(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    heap_bench();
+    return 0;
+}
+
+static int cmd_bootinfo(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    boot_profile_print();
+    return 0;
+}
+
+static int cmd_clock(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    kprintf("System clock: %u Hz %s\n", sysclk_get_hz(),
+            sysclk_pll_locked() ? "(PLL)" : "(PLL not locked, running from crystal)");
+    return 0;
+}
+
+static int cmd_irqlat(int argc, const ShellArg *argv) {
+    nvic_latency_test(argc > 1 && argv[1].num > 0 ? argv[1].num : 100);
+    return 0;
+}
+
+static int cmd_membench(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    mem_bench();
+    return 0;
+}
+
+static int cmd_pools(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    pool_print_stats();
+    return 0;
+}
+
+static int cmd_ps(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    sched_print_stats();
+    return 0;
+}
+
+static int cmd_timers(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    timer_print();
+    return 0;
+}
+
+// 'timer stop' atau 'timer <ms> [period]': argumen pertama bisa kata atau angka.
+static int cmd_timer(int argc, const ShellArg *argv) {
+    uint32_t delay, period = 0;
+    if (strcmp(argv[1].str, "stop") == 0 && argc == 2) {
+        timer_demo_stop();
+        return 0;
+    }
+    if (shell_parse_num(argv[1].str, 10, &delay) != 0 || delay == 0 ||
+        (argc > 2 && shell_parse_num(argv[2].str, 10, &period) != 0)) {
+        return -1;
+    }
+    if (timer_demo_start(delay, period) != 0) {
+        print_str("Error: Too many timers.\n");
+    }
+    return 0;
+}
+
+static int cmd_timerbench(int argc, const ShellArg *argv) {
+    timer_bench(argc > 1 && argv[1].num > 0 ? argv[1].num : 500);
+    return 0;
+}
+
+static int cmd_workq(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    workq_print_stats();
+    return 0;
+}
+
+static int cmd_workbench(int argc, const ShellArg *argv) {
+    workq_test(argc > 1 && argv[1].num > 0 ? argv[1].num : 100);
+    return 0;
+}
+
+static int cmd_mbox(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    mbox_print_stats();
+    return 0;
+}
+
+static int cmd_mboxbench(int argc, const ShellArg *argv) {
+    mbox_test(argc > 1 && argv[1].num > 0 ? argv[1].num : 100);
+    return 0;
+}
+
+static int cmd_loglevel(int argc, const ShellArg *argv) {
+    if (argc == 2) return -1;
+    if (argc == 3 && log_set_level(argv[1].str, argv[2].str) != 0) return -1;
+    log_print_levels();
+    return 0;
+}
+
+// 'trace' tanpa argumen hanya mencetak status.
+static int cmd_trace(int argc, const ShellArg *argv) {
+    if (argc > 1) {
+        const char *op = argv[1].str;
+        if (strcmp(op, "mark") == 0) {
+            uint32_t value = 0;
+            if (argc < 3 || shell_parse_num(argv[2].str, 10, &value) != 0) return -1;
+            TRACE(TRACE_EV_MARK, value, 0);
+        } else if (argc > 2) {
+            return -1;
+        } else if (strcmp(op, "start") == 0) {
+            trace_start();
+        } else if (strcmp(op, "stop") == 0) {
+            trace_stop();
+        } else if (strcmp(op, "clear") == 0) {
+            trace_clear();
+        } else if (strcmp(op, "dump") == 0) {
+            trace_dump();
+            return 0;
+        } else {
+            return -1;
         }
-        command_name[i] = '\0';
+    }
+    trace_print_status();
+    return 0;
+}
 
-        if (args_ptr[i] == ' ') {
-            args_ptr += i + 1;
-            while (*args_ptr == ' ') args_ptr++;
+static int cmd_locks(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    sync_print_stats();
+    return 0;
+}
+
+static int cmd_tickless(int argc, const ShellArg *argv) {
+    if (argc > 1) {
+        if (strcmp(argv[1].str, "on") == 0) {
+            tickless_enable(1);
+        } else if (strcmp(argv[1].str, "off") == 0) {
+            tickless_enable(0);
         } else {
-            args_ptr += i;
+            return -1;
         }
+    }
+    tickless_print_stats();
+    return 0;
+}
 
-        if (strcmp(command_name, "help") == 0) {
-            print_str("Available commands:\n");
-            print_str("  help               - Display this help message\n");
-            print_str("  echo <text>        - Echoes back the input\n");
-            print_str("  clear              - Clears the terminal screen\n");
-            print_str("  meminfo            - Display heap memory information\n");
-            print_str("  heapmap            - Display a visual map of the heap\n");
-            print_str("  alloc <size>       - Allocate memory from heap\n");
-            print_str("  calloc <n> <size>  - Allocate and zero-initialize memory\n");
-            print_str("  realloc <addr> <sz>- Reallocate memory\n");
-            print_str("  free <addr>        - Free memory from heap (e.g., free 0x20000100)\n");
-            print_str("  peek <addr>        - Read a 32-bit value from a memory address\n");
-            print_str("  poke <addr> <val>  - Write a 32-bit value to a memory address\n");
-            print_str("  fill <addr> <val> <count> - Fill memory with a value\n");
-            print_str("  panic_test         - Test the kernel panic handler\n");
-            print_str("  exit               - Exits the QEMU emulator\n");
-        } else if (strcmp(command_name, "clear") == 0) {
-            clear_screen();
-        } else if (strcmp(command_name, "echo") == 0) {
-            print_str(args_ptr);
-            print_str("\n");
-        } else if (strcmp(command_name, "meminfo") == 0) {
-            print_str("Heap Information:\n");
-            print_str("  Heap Start: "); print_hex((uint32_t)&__heap_start__); print_str("\n");
-            print_str("  Heap End:   "); print_hex((uint32_t)&__heap_end__); print_str("\n");
-            BlockHeader* current = (BlockHeader*)&__heap_start__;
-            while((uint32_t)current < (uint32_t)&__heap_end__ && current->size > 0) {
-                print_str("  Block at "); print_hex((uint32_t)current);
-                print_str(" | Size: "); itoa(current->size, temp_str); print_str(temp_str);
-                print_str(" | Free: "); print_str(current->free ? "Yes" : "No");
-                if (!current->free) {
-                    print_str(" | Magic: "); print_hex(current->magic);
-                }
-                print_str("\n");
-                current = (BlockHeader*)((uint8_t*)current + current->size);
-            }
-        } else if (strcmp(command_name, "heapmap") == 0) {
-            print_heap_map();
-        } else if (strcmp(command_name, "alloc") == 0) {
-            int size_to_alloc = atoi(args_ptr, NULL);
-            if (size_to_alloc > 0) {
-                void* p = malloc(size_to_alloc);
-                if (p) {
-                    print_str("Allocated "); itoa(size_to_alloc, temp_str); print_str(temp_str);
-                    print_str(" bytes at "); print_hex((uint32_t)p); print_str("\n");
-                } else {
-                    print_str("Allocation failed.\n");
-                }
-            }
-        } else if (strcmp(command_name, "calloc") == 0) {
-            const char *num_ptr_end = NULL;
-            int num = atoi(args_ptr, &num_ptr_end);
-            while (*num_ptr_end == ' ') num_ptr_end++;
-            int size = atoi(num_ptr_end, NULL);
-            if (num > 0 && size > 0) {
-                void* p = calloc(num, size);
-                if (p) {
-                    print_str("Allocated "); itoa(num * size, temp_str); print_str(temp_str);
-                    print_str(" bytes at "); print_hex((uint32_t)p); print_str(" (zeroed)\n");
-                } else {
-                    print_str("Calloc failed.\n");
-                }
-            } else {
-                print_str("Usage: calloc <num_elements> <size_per_element>\n");
-            }
-        } else if (strcmp(command_name, "realloc") == 0) {
-             const char* addr_ptr_end = NULL;
-             uint32_t addr = htoi(args_ptr, &addr_ptr_end);
-             while(*addr_ptr_end == ' ') addr_ptr_end++;
-             int new_size = atoi(addr_ptr_end, NULL);
-             if (addr > 0 && new_size > 0) {
-                 void* p = realloc((void*)addr, new_size);
-                 if (p) {
-                    print_str("Reallocated to "); itoa(new_size, temp_str); print_str(temp_str);
-                    print_str(" bytes at "); print_hex((uint32_t)p); print_str("\n");
-                 } else {
-                    // Pesan error sudah dicetak di dalam realloc
-                 }
-             } else {
-                 print_str("Usage: realloc <hex_address> <new_size>\n");
-             }
-        } else if (strcmp(command_name, "free") == 0) {
-             uint32_t addr = htoi(args_ptr, NULL);
-             if (addr > 0) {
-                free((void*)addr);
-             } else {
-                print_str("Usage: free <hex_address>\n");
-             }
-        } else if (strcmp(command_name, "peek") == 0) {
-            uint32_t addr = htoi(args_ptr, NULL);
-            if (addr > 0) {
-                uint32_t value = *(volatile uint32_t*)addr;
-                print_str("Value at "); print_hex(addr);
-                print_str(" is "); print_hex(value); print_str("\n");
-            } else {
-                print_str("Usage: peek <hex_address>\n");
-            }
-        } else if (strcmp(command_name, "poke") == 0) {
-            const char* addr_ptr_end = NULL;
-            uint32_t addr = htoi(args_ptr, &addr_ptr_end);
-            while(*addr_ptr_end == ' ') addr_ptr_end++;
-            uint32_t value = htoi(addr_ptr_end, NULL);
-            if (addr > 0) {
-                *(volatile uint32_t*)addr = value;
-                print_str("Wrote "); print_hex(value);
-                print_str(" to "); print_hex(addr); print_str("\n");
-            } else {
-                print_str("Usage: poke <hex_address> <hex_value>\n");
-            }
-        } else if (strcmp(command_name, "fill") == 0) {
-            const char* ptr1, *ptr2;
-            uint32_t addr = htoi(args_ptr, &ptr1);
-            while(*ptr1 == ' ') ptr1++;
-            uint32_t value = htoi(ptr1, &ptr2);
-            while(*ptr2 == ' ') ptr2++;
-            int count = atoi(ptr2, NULL);
-            if (addr > 0 && count > 0) {
-                for (int j = 0; j < count; j++) {
-                    *(uint8_t*)(addr + j) = (uint8_t)value;
-                }
-                print_str("Filled "); itoa(count, temp_str); print_str(temp_str);
-                print_str(" bytes at "); print_hex(addr);
-                print_str(" with value "); print_hex(value); print_str("\n");
-            } else {
-                print_str("Usage: fill <hex_addr> <hex_value> <count>\n");
+static int cmd_jobs(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    jobs_print();
+    return 0;
+}
+
+static int cmd_kill(int argc, const ShellArg *argv) {
+    (void)argc;
+    if (job_kill(argv[1].num) != 0) {
+        print_str("No such job.\n");
+    }
+    return 0;
+}
+
+static int cmd_alloc(int argc, const ShellArg *argv) {
+    (void)argc;
+    uint32_t size = argv[1].num;
+    if (size == 0) return -1;
+    void* p = malloc(size);
+    if (p) {
+        kprintf("Allocated %u bytes at %p\n", size, p);
+    } else {
+        print_str("Allocation failed.\n");
+    }
+    return 0;
+}
+
+static int cmd_calloc(int argc, const ShellArg *argv) {
+    (void)argc;
+    uint32_t count = argv[1].num, size = argv[2].num;
+    if (count == 0 || size == 0) return -1;
+    void* p = calloc(count, size);
+    if (p) {
+        kprintf("Allocated %u bytes at %p (zeroed)\n", count * size, p);
+    } else {
+        print_str("Calloc failed.\n");
+    }
+    return 0;
+}
+
+static int cmd_realloc(int argc, const ShellArg *argv) {
+    (void)argc;
+    uint32_t addr = argv[1].num, new_size = argv[2].num;
+    if (addr == 0 || new_size == 0) return -1;
+    void* p = realloc((void*)addr, new_size);
+    if (p) {
+        kprintf("Reallocated to %u bytes at %p (%s)\n", new_size, p,
+                (uint32_t)p == addr ? "in place" : "moved");
+    }
+    // Jika gagal, pesan error sudah dicetak di dalam realloc
+    return 0;
+}
+
+static int cmd_free(int argc, const ShellArg *argv) {
+    (void)argc;
+    if (argv[1].num == 0) return -1;
+    free((void*)argv[1].num);
+    return 0;
+}
+
+static int cmd_peek(int argc, const ShellArg *argv) {
+    (void)argc;
+    uint32_t addr = argv[1].num;
+    if (addr == 0) return -1;
+    uint32_t value = *(volatile uint32_t*)addr;
+    kprintf("Value at %p is 0x%08x\n", (void*)addr, value);
+    return 0;
+}
+
+static int cmd_poke(int argc, const ShellArg *argv) {
+    (void)argc;
+    uint32_t addr = argv[1].num, value = argv[2].num;
+    if (addr == 0) return -1;
+    *(volatile uint32_t*)addr = value;
+    kprintf("Wrote 0x%08x to %p\n", value, (void*)addr);
+    return 0;
+}
+
+// Mode 'w' mengisi word 32-bit; alamatnya harus word aligned.
+static int cmd_fill(int argc, const ShellArg *argv) {
+    uint32_t addr = argv[1].num, value = argv[2].num, count = argv[3].num;
+    int word_mode = 0;
+    if (argc > 4) {
+        if (strcmp(argv[4].str, "w") != 0) return -1;
+        word_mode = 1;
+    }
+    if (addr == 0 || count == 0 || (word_mode && (addr & 3))) return -1;
+    if (word_mode) {
+        memset32((void*)addr, value, count);
+    } else {
+        memset((void*)addr, (int)value, count);
+    }
+    kprintf("Filled %u %s at %p with value 0x%x\n", count, word_mode ? "words" : "bytes",
+            (void*)addr, value);
+    return 0;
+}
+
+static int cmd_uart(int argc, const ShellArg *argv) {
+    if (argc > 1) {
+        if (strcmp(argv[1].str, "block") == 0) {
+            uart0_set_tx_policy(0);
+        } else if (strcmp(argv[1].str, "drop") == 0) {
+            uart0_set_tx_policy(1);
+        } else {
+            return -1;
+        }
+    }
+    uint32_t queued, dropped;
+    int policy = uart0_tx_stats(&queued, &dropped);
+    kprintf("UART0 TX:\n"
+            "  Policy:  %s\n"
+            "  Queued:  %u bytes\n"
+            "  Dropped: %u bytes\n", policy ? "drop" : "block", queued, dropped);
+    uint32_t buffered, overruns;
+    uart0_rx_stats(&buffered, &dropped, &overruns);
+    kprintf("UART0 RX:\n"
+            "  Buffered: %u bytes\n"
+            "  Dropped:  %u bytes\n"
+            "  Overruns: %u\n", buffered, dropped, overruns);
+    return 0;
+}
+
+static int cmd_panic_test(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    panic("User-initiated test");
+    return 0;
+}
+
+static int cmd_exit(int argc, const ShellArg *argv) {
+    (void)argc; (void)argv;
+    print_str("Exiting Amadeus OS...\n");
+    uart0_flush();
+    shell_exit = 1;
+    return 0;
+}
+
+// Harus urut nama (strcmp); shell_init() memeriksanya saat boot.
+static const ShellCommand shell_commands[] = {
+    { "alloc",      cmd_alloc,      "d",    "<size>",               "Allocate memory from heap" },
+    { "bootinfo",   cmd_bootinfo,   "",     "",                     "Display boot phase timings and uptime" },
+    { "calloc",     cmd_calloc,     "dd",   "<n> <size>",           "Allocate and zero-initialize memory" },
+    { "clear",      cmd_clear,      "",     "",                     "Clears the terminal screen" },
+    { "clock",      cmd_clock,      "",     "",                     "Display the system clock frequency" },
+    { "echo",       cmd_echo,       "R",    "<text>",               "Echoes back the input" },
+    { "exit",       cmd_exit,       "",     "",                     "Exits the QEMU emulator" },
+    { "fill",       cmd_fill,       "xxdS", "<addr> <val> <count> [w]", "Fill memory with a byte (or 32-bit word) value" },
+    { "free",       cmd_free,       "x",    "<addr>",               "Free memory from heap (e.g., free 0x20000100)" },
+    { "heapbench",  cmd_heapbench,  "",     "",                     "Compare best-fit scan vs segregated fit" },
+    { "heapmap",    cmd_heapmap,    "",     "",                     "Display a visual map of the heap" },
+    { "help",       cmd_help,       "",     "",                     "Display this help message" },
+    { "irqlat",     cmd_irqlat,     "D",    "[samples]",            "Measure interrupt entry latency and jitter" },
+    { "jobs",       cmd_jobs,       "",     "",                     "List background jobs" },
+    { "kill",       cmd_kill,       "d",    "<id>",                 "Stop a background job" },
+    { "locks",      cmd_locks,      "",     "",                     "List mutexes/semaphores/events and contention" },
+    { "loglevel",   cmd_loglevel,   "SS",   "[sys|all <level>]",    "Show or set log levels (none/error/warn/info/debug)" },
+    { "mbox",       cmd_mbox,       "",     "",                     "Show mailbox depth and latency" },
+    { "mboxbench",  cmd_mboxbench,  "D",    "[n]",                  "Pass n pool buffers to a receiver task" },
+    { "membench",   cmd_membench,   "",     "",                     "Measure memcpy/memset bytes per cycle" },
+    { "meminfo",    cmd_meminfo,    "",     "",                     "Display heap memory information" },
+    { "panic_test", cmd_panic_test, "",     "",                     "Test the kernel panic handler" },
+    { "peek",       cmd_peek,       "x",    "<addr>",               "Read a 32-bit value from a memory address" },
+    { "poke",       cmd_poke,       "xx",   "<addr> <val>",         "Write a 32-bit value to a memory address" },
+    { "pools",      cmd_pools,      "",     "",                     "Display object pool usage" },
+    { "ps",         cmd_ps,         "",     "",                     "Display tasks, CPU time and context switches" },
+    { "realloc",    cmd_realloc,    "xd",   "<addr> <sz>",          "Reallocate memory" },
+    { "tickless",   cmd_tickless,   "S",    "[on|off]",             "Show idle sleep stats, toggle tick suppression" },
+    { "timer",      cmd_timer,      "sS",   "<ms> [period] | stop", "Start a timer that prints when it fires, or cancel them" },
+    { "timerbench", cmd_timerbench, "D",    "[n]",                  "Measure timer start/cancel cost with n timers" },
+    { "timers",     cmd_timers,     "",     "",                     "List active software timers" },
+    { "trace",      cmd_trace,      "SS",   "[start|stop|clear|dump|mark <n>]", "Record kernel events in RAM; dump for tools/trace_decode.py" },
+    { "uart",       cmd_uart,       "S",    "[block|drop]",         "Show UART TX/RX stats / set TX full-buffer policy" },
+    { "workbench",  cmd_workbench,  "D",    "[n]",                  "Time n ISR posts against the deferred work" },
+    { "workq",      cmd_workq,      "",     "",                     "Show deferred work items and timing" },
+};
+
+#define SHELL_COMMAND_COUNT (sizeof(shell_commands) / sizeof(shell_commands[0]))
+
+// Loop shell: baca satu baris, jalankan perintahnya. Berjalan sebagai task sendiri.
+static void shell_task(void *arg) {
+    (void)arg;
+    print_str(greet);
+
+    while (!shell_exit) {
+        // Buang semua alokasi scratch dari perintah sebelumnya dalam O(1)
+        arena_reset(&scratch);
+        char *line_buffer = arena_alloc(&scratch, MAX_LINE_LENGTH);
+
+        print_str("AmadeusOS> ");
+        boot_stamp(BOOT_PHASE_PROMPT); // Hanya tercatat pada prompt pertama
+        readline(line_buffer, MAX_LINE_LENGTH);
+
+        // Akhiran '&' menjalankan perintah sebagai background job
+        int background = 0;
+        int len = strlen(line_buffer);
+        while (len > 0 && line_buffer[len - 1] == ' ') len--;
+        if (len > 0 && line_buffer[len - 1] == '&') {
+            background = 1;
+            len--;
+            while (len > 0 && line_buffer[len - 1] == ' ') len--;
+        }
+        line_buffer[len] = '\0';
+
+        if (background) {
+            char *argv[SHELL_MAX_ARGS];
+            int argc = shell_tokenize(line_buffer, argv, SHELL_MAX_ARGS);
+            if (argc > 0) {
+                job_spawn(argc, argv);
             }
-        } else if (strcmp(command_name, "panic_test") == 0) {
-            panic("User-initiated test");
-        } else if (strcmp(command_name, "exit") == 0) {
-            print_str("Exiting Amadeus OS...\n");
-            return;
-        } else if (command_name[0] != '\0') {
-            print_str("Command not found: ");
-            print_str(command_name);
-            print_str("\n");
+        } else {
+            shell_execute(line_buffer);
         }
     }
+    // Task shell berakhir, hanya task idle yang tersisa
+}
+
+void main(void) {
+    systick_init();
+    uart0_init();
+    boot_stamp(BOOT_PHASE_UART);
+    malloc_init();
+    boot_stamp(BOOT_PHASE_HEAP);
+    arena_init(&scratch, scratch_mem, sizeof(scratch_mem));
+
+    sched_init();
+    jobs_init();
+    timer_init();
+    workq_init();
+    shell_init(shell_commands, SHELL_COMMAND_COUNT);
+    if (task_create("shell", shell_task, NULL, SHELL_TASK_PRIORITY, SHELL_STACK_SIZE) == NULL) {
+        panic("Cannot create shell task");
+    }
+    sched_start(); // Tidak pernah kembali
 }
@@ -0,0 +1,316 @@
+#include "cpu.h"
+#include "pool.h"
+#include "sched.h"
+#include "jobs.h"
+#include "shell.h"
+
+void print_str(const char *str);
+void print_hex(uint32_t n);
+void itoa(int n, char *s);
+int strcmp(const char *s1, const char *s2);
+void strncpy(char *dest, const char *src, int n);
+
+// Converts milliseconds to SysTick ticks, rounding up to at least one tick.
+#define MS_TO_TICKS(ms) (((ms) * SYSTICK_HZ + 999) / 1000)
+
+typedef struct {
+    const char *name;
+    const char *spec;  // Argument spec, see shell.h
+    int (*parse)(Job *job, int argc, const ShellArg *argv); // Fills job->arg, returns -1 on bad input
+    int (*fn)(Job *job);
+    const char *args;  // For 'help' and usage
+    const char *help;
+} JobCommand;
+
+static Pool job_pool;
+static Job *job_list;           // Owned by the runner task
+static Job *job_incoming;       // Newly spawned jobs, newest first, handed to the runner
+static Task *jobs_runner;
+static uint16_t next_job_id = 1;
+
+/**
+ * @brief Prints "[id] " in front of a job's output.
+ */
+static void job_print_prefix(const Job *job)
+{
+    char num[12];
+    print_str("["); itoa(job->id, num); print_str(num); print_str("] ");
+}
+
+// --- sleep <ms>: finishes after the given time. ---
+
+static int job_parse_sleep(Job *job, int argc, const ShellArg *argv)
+{
+    (void)argc;
+    if (argv[1].num == 0) return -1;
+    job->arg[0] = MS_TO_TICKS(argv[1].num);
+    return 0;
+}
+
+static int job_sleep(Job *job)
+{
+    CORO_BEGIN(&job->coro);
+    CORO_SLEEP(&job->coro, job->arg[0]);
+    CORO_END(&job->coro);
+}
+
+// --- ticker <ms> [count]: prints a line every interval, forever if count is 0. ---
+
+static int job_parse_ticker(Job *job, int argc, const ShellArg *argv)
+{
+    if (argv[1].num == 0) return -1;
+    job->arg[0] = MS_TO_TICKS(argv[1].num);
+    job->arg[1] = (argc > 2) ? argv[2].num : 0;
+    job->arg[2] = 0;
+    return 0;
+}
+
+static int job_ticker(Job *job)
+{
+    char num[12];
+
+    CORO_BEGIN(&job->coro);
+    while (job->arg[1] == 0 || job->arg[2] < job->arg[1]) {
+        CORO_SLEEP(&job->coro, job->arg[0]);
+        job->arg[2]++;
+        job_print_prefix(job);
+        print_str("tick "); itoa(job->arg[2], num); print_str(num); print_str("\n");
+    }
+    CORO_END(&job->coro);
+}
+
+// --- watch <hex_addr> [ms]: reports every change of a 32-bit word. ---
+
+static int job_parse_watch(Job *job, int argc, const ShellArg *argv)
+{
+    if ((argv[1].num & 3) != 0) return -1;
+    uint32_t ms = (argc > 2 && argv[2].num > 0) ? argv[2].num : 100;
+    job->arg[0] = argv[1].num;
+    job->arg[1] = MS_TO_TICKS(ms);
+    return 0;
+}
+
+static int job_watch(Job *job)
+{
+    CORO_BEGIN(&job->coro);
+    job->arg[2] = *(volatile uint32_t *)job->arg[0];
+    job_print_prefix(job);
+    print_hex(job->arg[0]); print_str(" = "); print_hex(job->arg[2]); print_str("\n");
+    while (1) {
+        CORO_SLEEP(&job->coro, job->arg[1]);
+        uint32_t value = *(volatile uint32_t *)job->arg[0];
+        if (value != job->arg[2]) {
+            job->arg[2] = value;
+            job_print_prefix(job);
+            print_hex(job->arg[0]); print_str(" = "); print_hex(value); print_str("\n");
+        }
+    }
+    CORO_END(&job->coro);
+}
+
+static const JobCommand job_commands[] = {
+    { "sleep",  "d",  job_parse_sleep,  job_sleep,  "<ms> &",        "Background job that finishes after <ms>" },
+    { "ticker", "dD", job_parse_ticker, job_ticker, "<ms> [n] &",    "Background job printing a tick every <ms>" },
+    { "watch",  "xD", job_parse_watch,  job_watch,  "<addr> [ms] &", "Background job reporting changes of a word" },
+};
+
+#define JOB_COMMAND_COUNT (sizeof(job_commands) / sizeof(job_commands[0]))
+
+/**
+ * @brief Moves newly spawned jobs to the tail of the runner's list, oldest first.
+ *
+ * job_list is only ever modified by the runner, so the shell can walk it in
+ * 'jobs' while the runner is preempted.
+ */
+static void jobs_take_incoming(void)
+{
+    uint32_t primask = irq_save();
+    Job *incoming = job_incoming;
+    job_incoming = NULL;
+    irq_restore(primask);
+
+    Job *reversed = NULL;
+    while (incoming != NULL) {
+        Job *job = incoming;
+        incoming = job->next;
+        job->next = reversed;
+        reversed = job;
+    }
+
+    Job **link = &job_list;
+    while (*link != NULL) {
+        link = &(*link)->next;
+    }
+    *link = reversed;
+}
+
+/**
+ * @brief Runner task: steps every job once per pass.
+ *
+ * Jobs that yielded are run again right away; if every job is waiting, the
+ * runner sleeps for one tick before polling their conditions again. With no
+ * jobs at all it blocks until job_spawn() wakes it.
+ */
+static void jobs_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        jobs_take_incoming();
+
+        if (job_list == NULL) {
+            uint32_t primask = irq_save();
+            if (job_incoming == NULL) {
+                sched_block();
+            }
+            irq_restore(primask);
+            continue;
+        }
+
+        int yielded = 0;
+        Job **link = &job_list;
+        while (*link != NULL) {
+            Job *job = *link;
+            int result = job->killed ? CORO_ENDED : job->fn(job);
+
+            if (result == CORO_ENDED) {
+                *link = job->next; // A single store, so a concurrent 'jobs' never sees a broken list.
+                job_print_prefix(job);
+                print_str(job->killed ? "Killed " : "Done ");
+                print_str(job->name); print_str("\n");
+                pool_free(&job_pool, job);
+                continue;
+            }
+            if (result == CORO_YIELDED) {
+                yielded = 1;
+            }
+            link = &job->next;
+        }
+
+        if (yielded) {
+            task_yield();
+        } else {
+            task_sleep(1);
+        }
+    }
+}
+
+/**
+ * @brief Creates the job pool and the runner task.
+ */
+void jobs_init(void)
+{
+    pool_create(&job_pool, "jobs", sizeof(Job), JOBS_MAX);
+    jobs_runner = task_create("jobs", jobs_task, NULL, JOBS_TASK_PRIORITY, JOBS_STACK_SIZE);
+}
+
+/**
+ * @brief Starts a background-capable command as a job ('command &').
+ * @param argc Number of words, including the command name.
+ * @param argv Words from shell_tokenize(), without the trailing '&'.
+ * @return The job ID, or -1 if the command is unknown, the arguments are
+ *         invalid or all JOBS_MAX jobs are in use. The reason is printed.
+ */
+int job_spawn(int argc, char **argv)
+{
+    const char *name = argv[0];
+    ShellArg args[SHELL_MAX_ARGS];
+    const JobCommand *cmd = NULL;
+    for (uint32_t i = 0; i < JOB_COMMAND_COUNT; i++) {
+        if (strcmp(name, job_commands[i].name) == 0) {
+            cmd = &job_commands[i];
+            break;
+        }
+    }
+    if (cmd == NULL) {
+        print_str("Command cannot run in background: "); print_str(name); print_str("\n");
+        return -1;
+    }
+
+    argc = shell_parse_args(cmd->spec, argc, argv, args);
+    if (argc < 0) {
+        shell_print_usage(cmd->name, cmd->args);
+        return -1;
+    }
+    Job *job = pool_alloc(&job_pool);
+    if (job == NULL) {
+        print_str("Error: Too many jobs.\n");
+        return -1;
+    }
+    if (cmd->parse(job, argc, args) != 0) {
+        pool_free(&job_pool, job);
+        shell_print_usage(cmd->name, cmd->args);
+        return -1;
+    }
+
+    CORO_INIT(&job->coro);
+    job->fn = cmd->fn;
+    job->killed = 0;
+    strncpy(job->name, cmd->name, JOB_NAME_LEN - 1);
+    job->name[JOB_NAME_LEN - 1] = '\0';
+
+    uint32_t primask = irq_save();
+    job->id = next_job_id++;
+    job->next = job_incoming;
+    job_incoming = job;
+    sched_wake(jobs_runner);
+    irq_restore(primask);
+
+    job_print_prefix(job); print_str(job->name); print_str("\n");
+    return job->id;
+}
+
+/**
+ * @brief Prints the 'help' lines of the background-capable commands.
+ */
+void jobs_print_help(void)
+{
+    for (uint32_t i = 0; i < JOB_COMMAND_COUNT; i++) {
+        shell_print_help_line(job_commands[i].name, job_commands[i].args, job_commands[i].help);
+    }
+}
+
+/**
+ * @brief Asks a job to stop; the runner removes it on its next pass.
+ * @return 0 on success, -1 if no job has that ID.
+ */
+int job_kill(int id)
+{
+    Job *lists[2] = { job_list, job_incoming };
+    for (int l = 0; l < 2; l++) {
+        for (Job *job = lists[l]; job != NULL; job = job->next) {
+            if (job->id == id) {
+                job->killed = 1;
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Lists the running background jobs ('jobs' command).
+ */
+void jobs_print(void)
+{
+    char num[12];
+    int count = 0;
+    Job *lists[2] = { job_list, job_incoming };
+
+    for (int l = 0; l < 2; l++) {
+        for (Job *job = lists[l]; job != NULL; job = job->next) {
+            print_str("  "); job_print_prefix(job); print_str(job->name);
+            print_str(job->killed ? " | killing" : " | running");
+            print_str(" | Line: "); itoa(job->coro.lc, num); print_str(num);
+            print_str("\n");
+            count++;
+        }
+    }
+    if (count == 0) {
+        print_str("No background jobs.\n");
+        return;
+    }
+    print_str("Jobs: "); itoa(count, num); print_str(num);
+    print_str("/"); itoa(JOBS_MAX, num); print_str(num);
+    print_str(" ("); itoa(sizeof(Job), num); print_str(num); print_str(" bytes each)\n");
+}
@@ -0,0 +1,34 @@
+#ifndef __JOBS_H_
+#define __JOBS_H_
+
+#include <stdint.h>
+#include "coro.h"
+
+/*
+ * Background job shell ('perintah &').
+ * Setiap job adalah coroutine stackless (coro.h); semuanya dijalankan
+ * bergantian oleh satu task 'jobs' berprioritas di bawah shell, sehingga job
+ * tetap berjalan di sela-sela ketikan tanpa stack sendiri.
+ */
+#define JOBS_MAX            32   // Ukuran pool 'jobs'
+#define JOB_NAME_LEN        12
+#define JOBS_TASK_PRIORITY  16   // Di bawah shell, di atas idle
+#define JOBS_STACK_SIZE     1024
+
+typedef struct Job {
+    Coro coro;
+    uint16_t id;
+    uint8_t killed;              // Diset oleh job_kill(), diproses runner
+    int (*fn)(struct Job *job);  // Badan coroutine
+    struct Job *next;
+    uint32_t arg[3];             // Argumen dan state yang bertahan melewati yield
+    char name[JOB_NAME_LEN];
+} Job;
+
+void jobs_init(void);
+int job_spawn(int argc, char **argv);
+int job_kill(int id);
+void jobs_print(void);
+void jobs_print_help(void);
+
+#endif // __JOBS_H_
@@ -0,0 +1,222 @@
+#include <stdint.h>
+#include "kprintf.h"
+
+void uart0_write(const char *buf, size_t len);
+
+#define KFMT_LEFT  0x01 // '-': pad on the right
+#define KFMT_ZERO  0x02 // '0': pad numbers with zeros
+
+/**
+ * @brief Output state shared by kprintf() and ksnprintf().
+ *
+ * When the buffer fills up it is handed to 'flush' and reused; without a
+ * flush function the rest of the output is counted but dropped.
+ */
+typedef struct KOut {
+    char *buf;
+    size_t size;   // Usable bytes in buf
+    size_t len;    // Bytes currently in buf
+    size_t total;  // Characters produced so far
+    void (*flush)(const char *buf, size_t len);
+} KOut;
+
+static const char kfmt_lower[] = "0123456789abcdef";
+static const char kfmt_upper[] = "0123456789ABCDEF";
+
+static void kout_putc(KOut *o, char c)
+{
+    o->total++;
+    if (o->len == o->size) {
+        if (o->flush == NULL) {
+            return;
+        }
+        o->flush(o->buf, o->len);
+        o->len = 0;
+    }
+    o->buf[o->len++] = c;
+}
+
+static void kout_pad(KOut *o, char c, int n)
+{
+    while (n-- > 0) {
+        kout_putc(o, c);
+    }
+}
+
+/**
+ * @brief Writes decimal digits backwards from 'end'.
+ *
+ * n / 10 is computed as (n * 0xCCCCCCCD) >> 35, which is exact for every
+ * 32-bit n and costs one UMULL instead of a division.
+ * @return The first digit.
+ */
+static char *kfmt_dec(char *end, uint32_t n)
+{
+    do {
+        uint32_t q = (uint32_t)(((uint64_t)n * 0xCCCCCCCDu) >> 35);
+        *--end = (char)('0' + (n - q * 10));
+        n = q;
+    } while (n != 0);
+    return end;
+}
+
+/**
+ * @brief Writes hex digits backwards from 'end', one nibble per shift.
+ * @return The first digit.
+ */
+static char *kfmt_hex(char *end, uint32_t n, const char *digits)
+{
+    do {
+        *--end = digits[n & 0xF];
+        n >>= 4;
+    } while (n != 0);
+    return end;
+}
+
+/**
+ * @brief Emits a converted field with its sign and padding.
+ * @param sign '-' or 0.
+ */
+static void kfmt_field(KOut *o, const char *s, int len, char sign, int width, int flags)
+{
+    int pad = width - len - (sign ? 1 : 0);
+
+    if (!(flags & (KFMT_LEFT | KFMT_ZERO))) kout_pad(o, ' ', pad);
+    if (sign) kout_putc(o, sign);
+    if (flags & KFMT_ZERO && !(flags & KFMT_LEFT)) kout_pad(o, '0', pad);
+    while (len-- > 0) {
+        kout_putc(o, *s++);
+    }
+    if (flags & KFMT_LEFT) kout_pad(o, ' ', pad);
+}
+
+/**
+ * @brief The formatter behind every public function.
+ */
+static void kformat(KOut *o, const char *fmt, va_list ap)
+{
+    char num[12]; // 10 decimal digits of a uint32_t, or 8 hex digits
+    char *end = num + sizeof(num);
+
+    for (; *fmt != '\0'; fmt++) {
+        if (*fmt != '%') {
+            kout_putc(o, *fmt);
+            continue;
+        }
+
+        int flags = 0;
+        int width = 0;
+        for (fmt++; *fmt == '-' || *fmt == '0'; fmt++) {
+            flags |= (*fmt == '-') ? KFMT_LEFT : KFMT_ZERO;
+        }
+        for (; *fmt >= '0' && *fmt <= '9'; fmt++) {
+            width = width * 10 + (*fmt - '0');
+        }
+        while (*fmt == 'l') {
+            fmt++;
+        }
+
+        char *s;
+        char sign = 0;
+        switch (*fmt) {
+        case 'd':
+        case 'i': {
+            int32_t v = va_arg(ap, int32_t);
+            uint32_t u = (uint32_t)v;
+            if (v < 0) {
+                sign = '-';
+                u = 0u - u;
+            }
+            s = kfmt_dec(end, u);
+            break;
+        }
+        case 'u':
+            s = kfmt_dec(end, va_arg(ap, uint32_t));
+            break;
+        case 'x':
+            s = kfmt_hex(end, va_arg(ap, uint32_t), kfmt_lower);
+            break;
+        case 'X':
+            s = kfmt_hex(end, va_arg(ap, uint32_t), kfmt_upper);
+            break;
+        case 'p':
+            // Always 0x plus eight digits, so addresses line up in columns.
+            kout_putc(o, '0');
+            kout_putc(o, 'x');
+            s = kfmt_hex(end, (uint32_t)(uintptr_t)va_arg(ap, void *), kfmt_lower);
+            flags = KFMT_ZERO;
+            width = 8;
+            break;
+        case 'c':
+            num[0] = (char)va_arg(ap, int);
+            kfmt_field(o, num, 1, 0, width, flags & KFMT_LEFT);
+            continue;
+        case 's': {
+            const char *str = va_arg(ap, const char *);
+            int len = 0;
+            if (str == NULL) str = "(null)";
+            while (str[len] != '\0') len++;
+            kfmt_field(o, str, len, 0, width, flags & KFMT_LEFT);
+            continue;
+        }
+        case '%':
+            kout_putc(o, '%');
+            continue;
+        case '\0':
+            return; // Lone '%' at the end
+        default:
+            // Unknown conversion: print it as written.
+            kout_putc(o, '%');
+            kout_putc(o, *fmt);
+            continue;
+        }
+        kfmt_field(o, s, end - s, sign, width, flags);
+    }
+}
+
+/**
+ * @brief Formats into 'buf' like vsnprintf.
+ * @return The length of the full output, even if it was truncated.
+ */
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+{
+    KOut o = { buf, size ? size - 1 : 0, 0, 0, NULL };
+    kformat(&o, fmt, ap);
+    if (size != 0) {
+        buf[o.len] = '\0';
+    }
+    return (int)o.total;
+}
+
+/**
+ * @brief Formats into 'buf' like snprintf.
+ * @return The length of the full output, even if it was truncated.
+ */
+int ksnprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = kvsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/**
+ * @brief Formats to the console; each KPRINTF_BUF_SIZE chunk goes to the UART
+ *        in one uart0_write() call.
+ * @return The number of characters printed.
+ */
+int kprintf(const char *fmt, ...)
+{
+    char buf[KPRINTF_BUF_SIZE];
+    KOut o = { buf, sizeof(buf), 0, 0, uart0_write };
+    va_list ap;
+
+    va_start(ap, fmt);
+    kformat(&o, fmt, ap);
+    va_end(ap);
+    if (o.len != 0) {
+        uart0_write(buf, o.len);
+    }
+    return (int)o.total;
+}
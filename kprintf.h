@@ -0,0 +1,24 @@
+#ifndef __KPRINTF_H_
+#define __KPRINTF_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/*
+ * Formatter gaya printf untuk kernel.
+ * - kprintf() memformat ke buffer di stack lalu menyerahkan isinya ke UART
+ *   dalam satu panggilan uart0_write(), bukan satu print_str() per field.
+ *   Baris yang lebih panjang dari buffer dikirim per potongan.
+ * - ksnprintf() menulis ke buffer pemanggil dan selalu mengakhirinya dengan
+ *   '\0'; nilai kembalinya panjang penuh seperti snprintf.
+ * - Konversi: %d %i %u %x %X %p %s %c %%, flag '-' dan '0', lebar field
+ *   (mis. %08x). Modifier 'l' diterima dan diabaikan (long = 32 bit).
+ * - Hex dengan shift/mask, desimal dengan perkalian resiprokal (tanpa UDIV).
+ */
+#define KPRINTF_BUF_SIZE  128 // Buffer stack kprintf()
+
+int kprintf(const char *fmt, ...);
+int ksnprintf(char *buf, size_t size, const char *fmt, ...);
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
+
+#endif // __KPRINTF_H_
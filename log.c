@@ -0,0 +1,106 @@
+#include <stdarg.h>
+#include "kprintf.h"
+#include "log.h"
+
+int strcmp(const char *s1, const char *s2);
+void uart0_write(const char *buf, size_t len);
+
+#define LOG_LINE_SIZE  KPRINTF_BUF_SIZE // Longer messages are truncated
+
+// Runtime levels, starting at each subsystem's compile-time limit.
+uint8_t log_levels[LOG_SYS_COUNT] = {
+    LOG_LEVEL_HEAP,
+    LOG_LEVEL_POOL,
+    LOG_LEVEL_SCHED,
+};
+
+// Compile-time limits, for 'loglevel'.
+static const uint8_t log_compiled[LOG_SYS_COUNT] = {
+    LOG_LEVEL_HEAP,
+    LOG_LEVEL_POOL,
+    LOG_LEVEL_SCHED,
+};
+
+static const char *const log_sys_names[LOG_SYS_COUNT] = { "heap", "pool", "sched" };
+static const char *const log_level_names[] = { "none", "error", "warn", "info", "debug" };
+
+#define LOG_LEVEL_COUNT (sizeof(log_level_names) / sizeof(log_level_names[0]))
+
+/**
+ * @brief Formats one message with its level prefix and sends it to the
+ *        console in a single write. Use the LOG_* macros instead.
+ */
+void log_write(uint32_t level, const char *fmt, ...)
+{
+    char line[LOG_LINE_SIZE];
+    int len = 0;
+    va_list ap;
+
+    if (level == LOG_LVL_ERROR) {
+        len = ksnprintf(line, sizeof(line), "Error: ");
+    } else if (level == LOG_LVL_WARN) {
+        len = ksnprintf(line, sizeof(line), "Warning: ");
+    }
+    va_start(ap, fmt);
+    len += kvsnprintf(line + len, sizeof(line) - len, fmt, ap);
+    va_end(ap);
+
+    if (len > (int)sizeof(line) - 1) {
+        len = sizeof(line) - 1;
+    }
+    uart0_write(line, len);
+}
+
+/**
+ * @brief Finds a level by name ("warn") or number ("2").
+ * @return The level, or -1 if unknown.
+ */
+static int log_parse_level(const char *s)
+{
+    if (s[0] >= '0' && s[0] <= '9' && s[1] == '\0') {
+        return (s[0] - '0' < (int)LOG_LEVEL_COUNT) ? s[0] - '0' : -1;
+    }
+    for (uint32_t i = 0; i < LOG_LEVEL_COUNT; i++) {
+        if (strcmp(s, log_level_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Sets the runtime level of one subsystem, or of all with "all".
+ *
+ * Levels above the compile-time limit are clamped to it, since those
+ * messages are not in the image.
+ * @return 0 on success, -1 if the subsystem or level is unknown.
+ */
+int log_set_level(const char *sys, const char *level)
+{
+    int lvl = log_parse_level(level);
+    if (lvl < 0) {
+        return -1;
+    }
+
+    int all = (strcmp(sys, "all") == 0);
+    int found = 0;
+    for (uint32_t i = 0; i < LOG_SYS_COUNT; i++) {
+        if (all || strcmp(sys, log_sys_names[i]) == 0) {
+            log_levels[i] = (lvl < log_compiled[i]) ? lvl : log_compiled[i];
+            found = 1;
+        }
+    }
+    return found ? 0 : -1;
+}
+
+/**
+ * @brief Lists every subsystem with its runtime and compile-time level
+ *        ('loglevel' command).
+ */
+void log_print_levels(void)
+{
+    for (uint32_t i = 0; i < LOG_SYS_COUNT; i++) {
+        kprintf("  %-6s %-6s (compiled: %s)\n", log_sys_names[i],
+                log_level_names[log_levels[i]], log_level_names[log_compiled[i]]);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef __LOG_H_
+#define __LOG_H_
+
+#include <stdint.h>
+
+/*
+ * Log diagnostik per subsistem.
+ * - Batas saat kompilasi: LOG_LEVEL (dari Makefile, mis. 'make LOG_LEVEL=0')
+ *   atau per subsistem LOG_LEVEL_<SUBSISTEM>. Pesan di atas batas hilang
+ *   seluruhnya: kondisinya konstan, jadi kode dan string-nya tidak ikut
+ *   di-compile (juga pada -O0).
+ * - Batas saat runtime: log_levels[], diubah dengan perintah 'loglevel'.
+ *   Tidak bisa melebihi batas kompilasi.
+ * - Pesan diformat dengan kprintf dan dikirim ke UART dalam satu panggilan.
+ *   Level error dan warning diberi awalan "Error: " / "Warning: ".
+ *
+ * Pemakaian: LOG_WARN(HEAP, "Double-free at %p\n", ptr);
+ */
+#define LOG_LVL_NONE   0
+#define LOG_LVL_ERROR  1
+#define LOG_LVL_WARN   2
+#define LOG_LVL_INFO   3
+#define LOG_LVL_DEBUG  4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LVL_DEBUG
+#endif
+
+// Batas kompilasi per subsistem; bawaan mengikuti LOG_LEVEL.
+#ifndef LOG_LEVEL_HEAP
+#define LOG_LEVEL_HEAP   LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_POOL
+#define LOG_LEVEL_POOL   LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_SCHED
+#define LOG_LEVEL_SCHED  LOG_LEVEL
+#endif
+
+enum {
+    LOG_SYS_HEAP,   // malloc/free/realloc (hello.c)
+    LOG_SYS_POOL,   // Object pool (pool.c)
+    LOG_SYS_SCHED,  // Scheduler (sched.c)
+    LOG_SYS_COUNT
+};
+
+extern uint8_t log_levels[LOG_SYS_COUNT];
+
+#define LOG_AT(sys, lvl, ...)                                                   \
+    do {                                                                        \
+        if (LOG_LEVEL_##sys >= (lvl) && log_levels[LOG_SYS_##sys] >= (lvl)) {   \
+            log_write((lvl), __VA_ARGS__);                                      \
+        }                                                                       \
+    } while (0)
+
+#define LOG_ERROR(sys, ...)  LOG_AT(sys, LOG_LVL_ERROR, __VA_ARGS__)
+#define LOG_WARN(sys, ...)   LOG_AT(sys, LOG_LVL_WARN, __VA_ARGS__)
+#define LOG_INFO(sys, ...)   LOG_AT(sys, LOG_LVL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(sys, ...)  LOG_AT(sys, LOG_LVL_DEBUG, __VA_ARGS__)
+
+void log_write(uint32_t level, const char *fmt, ...);
+int log_set_level(const char *sys, const char *level);
+void log_print_levels(void);
+
+#endif // __LOG_H_
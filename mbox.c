@@ -0,0 +1,303 @@
+#include "cpu.h"
+#include "mbox.h"
+#include "pool.h"
+#include "ring.h"
+#include "sched.h"
+#include "sync.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "trace.h"
+
+void *malloc(size_t size);
+void free(void *ptr);
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+#define MBOX_TEST_WORDS  7 // Payload words of a 'mboxbench' message
+
+/**
+ * @brief One queued message: the pointer and when it was sent.
+ */
+typedef struct MboxEntry {
+    void *msg;
+    uint32_t sent_at; // time_cycles() at mbox_send() (low 32 bits)
+} MboxEntry;
+
+typedef struct MboxTestMsg {
+    uint32_t seq;
+    uint32_t payload[MBOX_TEST_WORDS];
+} MboxTestMsg;
+
+static Mailbox *mbox_list; // Every created mailbox, for 'mbox'
+
+// 'mboxbench' state, created on first use.
+static Mailbox mbox_test_box;
+static Pool mbox_test_pool;
+static Task *mbox_test_receiver;
+static Semaphore mbox_test_done;          // Given when the receiver has seen every message
+static volatile uint32_t mbox_test_target; // Messages the receiver waits for
+static volatile uint32_t mbox_test_seen;
+static volatile uint32_t mbox_test_errors; // Out-of-order or corrupted messages
+
+/**
+ * @brief Creates an empty mailbox with room for 'depth' messages.
+ * @param depth Queue length; must be a power of two.
+ * @return 0 on success, -1 on invalid depth or out of memory.
+ */
+int mbox_create(Mailbox *mb, const char *name, uint32_t depth)
+{
+    if (depth == 0 || (depth & (depth - 1)) != 0) {
+        return -1;
+    }
+    MboxEntry *buf = malloc(depth * sizeof(MboxEntry));
+    uint8_t *seq = malloc(depth);
+    if (buf == NULL || seq == NULL) {
+        free(buf);
+        free(seq);
+        return -1;
+    }
+
+    ring_init(&mb->ring, buf, seq, sizeof(MboxEntry), depth);
+    sem_init(&mb->avail, name, 0);
+    mb->name = name;
+    mb->received = 0;
+    mb->full = 0;
+    mb->timeouts = 0;
+    mb->peak_depth = 0;
+    mb->max_latency = 0;
+    mb->total_latency = 0;
+
+    uint32_t primask = irq_save();
+    mb->next = mbox_list;
+    mbox_list = mb;
+    irq_restore(primask);
+    return 0;
+}
+
+/**
+ * @brief Sends a message pointer; ownership of the buffer passes to the
+ *        receiver. Never blocks; safe from any task or ISR.
+ * @return 0 on success, -1 if the mailbox is full (the caller keeps the buffer).
+ */
+int mbox_send(Mailbox *mb, void *msg)
+{
+    MboxEntry entry;
+    entry.msg = msg;
+    entry.sent_at = (uint32_t)time_cycles();
+
+    if (!ring_mp_push(&mb->ring, &entry)) {
+        mb->full++;
+        return -1;
+    }
+    TRACE(TRACE_EV_MBOX_SEND, mb, msg);
+    uint32_t depth = ring_count(&mb->ring);
+    if (depth > mb->peak_depth) {
+        mb->peak_depth = depth;
+    }
+    sem_give(&mb->avail);
+    return 0;
+}
+
+/**
+ * @brief Pops the entry a semaphore unit was taken for and records its latency.
+ *
+ * A unit can be taken while the oldest slot is still being written by a
+ * sender that was preempted after claiming it; that sender may have a lower
+ * priority than the receiver, so the receiver sleeps a tick rather than spin.
+ */
+static void *mbox_take(Mailbox *mb)
+{
+    MboxEntry entry;
+    while (!ring_pop(&mb->ring, &entry)) {
+        if (sched_running()) {
+            task_sleep(1);
+        }
+    }
+
+    TRACE(TRACE_EV_MBOX_RECV, mb, entry.msg);
+    uint32_t latency = (uint32_t)time_cycles() - entry.sent_at;
+    mb->received++;
+    mb->total_latency += latency;
+    if (latency > mb->max_latency) {
+        mb->max_latency = latency;
+    }
+    return entry.msg;
+}
+
+/**
+ * @brief Receives the oldest message, blocking until one arrives.
+ *        Only one task may receive from a mailbox.
+ * @return The message; the caller now owns its buffer.
+ */
+void *mbox_recv(Mailbox *mb)
+{
+    sem_take(&mb->avail);
+    return mbox_take(mb);
+}
+
+/**
+ * @brief Receives the oldest message, blocking for at most 'ticks' ticks.
+ * @return The message, or NULL on timeout.
+ */
+void *mbox_recv_timeout(Mailbox *mb, uint32_t ticks)
+{
+    if (sem_take_timeout(&mb->avail, ticks) != 0) {
+        mb->timeouts++;
+        return NULL;
+    }
+    return mbox_take(mb);
+}
+
+/**
+ * @brief Receives the oldest message without blocking.
+ * @return The message, or NULL if the mailbox is empty.
+ */
+void *mbox_tryrecv(Mailbox *mb)
+{
+    if (!sem_trytake(&mb->avail)) {
+        return NULL;
+    }
+    return mbox_take(mb);
+}
+
+/**
+ * @brief Returns the number of queued messages.
+ */
+uint32_t mbox_count(const Mailbox *mb)
+{
+    return ring_count(&mb->ring);
+}
+
+/**
+ * @brief Lists every mailbox with its depth and latency ('mbox' command).
+ */
+void mbox_print_stats(void)
+{
+    char num[12];
+    uint32_t cycles_per_us = sysclk_get_hz() / 1000000;
+
+    if (mbox_list == NULL) {
+        print_str("No mailboxes.\n");
+        return;
+    }
+    for (Mailbox *mb = mbox_list; mb != NULL; mb = mb->next) {
+        uint32_t depth = ring_count(&mb->ring);
+        print_str(mb->name);
+        print_str(" | Depth: "); itoa(depth, num); print_str(num);
+        print_str("/"); itoa(ring_capacity(&mb->ring), num); print_str(num);
+        print_str(" | Peak: "); itoa(mb->peak_depth, num); print_str(num);
+        print_str(" | Sent: "); itoa(mb->received + depth, num); print_str(num);
+        print_str(" | Received: "); itoa(mb->received, num); print_str(num);
+        print_str(" | Full: "); itoa(mb->full, num); print_str(num);
+        print_str(" | Timeouts: "); itoa(mb->timeouts, num); print_str(num);
+        if (mb->received != 0) {
+            print_str(" | Latency avg/max: ");
+            itoa((uint32_t)(mb->total_latency / mb->received) / cycles_per_us, num); print_str(num);
+            print_str("/"); itoa(mb->max_latency / cycles_per_us, num); print_str(num);
+            print_str(" us");
+        }
+        print_str("\n");
+    }
+}
+
+/**
+ * @brief 'mboxbench' receiver: checks and frees every message it is handed.
+ *
+ * Waits with a timeout so an idle mailbox shows up in the 'Timeouts' column.
+ */
+static void mbox_test_task(void *arg)
+{
+    (void)arg;
+    uint32_t expect = 0;
+
+    while (1) {
+        MboxTestMsg *m = mbox_recv_timeout(&mbox_test_box, SYSTICK_HZ);
+        if (m == NULL) {
+            continue;
+        }
+        if (mbox_test_seen == 0) {
+            expect = 0;
+        }
+        if (m->seq != expect || m->payload[MBOX_TEST_WORDS - 1] != ~m->seq) {
+            mbox_test_errors++;
+        }
+        expect = m->seq + 1;
+        pool_free(&mbox_test_pool, m);
+
+        if (++mbox_test_seen == mbox_test_target) {
+            sem_give(&mbox_test_done);
+        }
+    }
+}
+
+/**
+ * @brief Sends 'count' pool buffers to a receiver task and reports the cost
+ *        per message and the hand-over latency ('mboxbench').
+ */
+void mbox_test(uint32_t count)
+{
+    char num[12];
+    uint32_t cycles_per_us = sysclk_get_hz() / 1000000;
+
+    if (count == 0) return;
+    if ((mbox_test_box.name == NULL && mbox_create(&mbox_test_box, "bench", MBOX_TEST_DEPTH) != 0) ||
+        (mbox_test_pool.base == NULL &&
+         pool_create(&mbox_test_pool, "msgs", sizeof(MboxTestMsg), MBOX_TEST_MSGS) != 0)) {
+        print_str("Error: out of memory.\n");
+        return;
+    }
+    if (mbox_test_receiver == NULL) {
+        if (mbox_test_done.obj.name == NULL) {
+            sem_init(&mbox_test_done, "mboxbench", 0);
+        }
+        mbox_test_receiver = task_create("mbox", mbox_test_task, NULL, MBOX_TEST_PRIORITY, MBOX_TEST_STACK);
+        if (mbox_test_receiver == NULL) {
+            print_str("Error: cannot create receiver task.\n");
+            return;
+        }
+    }
+    while (sem_trytake(&mbox_test_done)) {
+        // Drop a completion left over from a run that timed out.
+    }
+
+    uint32_t received_before = mbox_test_box.received;
+    uint64_t latency_before = mbox_test_box.total_latency;
+    mbox_test_box.max_latency = 0;
+    mbox_test_errors = 0;
+    mbox_test_seen = 0;
+    mbox_test_target = count;
+
+    uint64_t start = time_cycles();
+    for (uint32_t i = 0; i < count; i++) {
+        MboxTestMsg *m;
+        while ((m = pool_alloc(&mbox_test_pool)) == NULL) {
+            task_sleep(1);
+        }
+        m->seq = i;
+        for (uint32_t w = 0; w < MBOX_TEST_WORDS; w++) {
+            m->payload[w] = i + w;
+        }
+        m->payload[MBOX_TEST_WORDS - 1] = ~i;
+        while (mbox_send(&mbox_test_box, m) != 0) {
+            task_sleep(1);
+        }
+    }
+    int timed_out = sem_take_timeout(&mbox_test_done, SYSTICK_HZ) != 0;
+    uint32_t cycles = (uint32_t)(time_cycles() - start);
+
+    uint32_t received = mbox_test_box.received - received_before;
+    print_str("Mailbox test ("); itoa(count, num); print_str(num); print_str(" messages):\n");
+    if (timed_out) {
+        print_str("  Timed out: only "); itoa(received, num); print_str(num);
+        print_str(" received.\n");
+    }
+    print_str("  Send+receive: "); itoa(cycles / count, num); print_str(num);
+    print_str(" cycles/msg | Errors: "); itoa(mbox_test_errors, num); print_str(num); print_str("\n");
+    if (received != 0) {
+        print_str("  Latency avg/max: ");
+        itoa((uint32_t)((mbox_test_box.total_latency - latency_before) / received), num); print_str(num);
+        print_str("/"); itoa(mbox_test_box.max_latency, num); print_str(num);
+        print_str(" cycles ("); itoa(mbox_test_box.max_latency / cycles_per_us, num); print_str(num);
+        print_str(" us max)\n");
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef __MBOX_H_
+#define __MBOX_H_
+
+#include <stdint.h>
+#include "ring.h"
+#include "sync.h"
+
+/*
+ * Mailbox: IPC zero-copy antar task (dan dari ISR ke task).
+ * - Yang dikirim hanya pointer. Pengirim mengambil buffer dari pool
+ *   (pool_alloc), mengisinya, lalu mbox_send(); sejak itu buffer milik
+ *   penerima, yang mengembalikannya dengan pool_free() setelah selesai.
+ * - Antrian adalah ring MPSC lock-free: banyak pengirim (task atau ISR),
+ *   satu task penerima per mailbox. mbox_send() tidak pernah memblokir.
+ * - Penerima menunggu lewat semaphore: mbox_recv() tanpa batas waktu,
+ *   mbox_recv_timeout() dengan batas tick, mbox_tryrecv() tanpa menunggu.
+ * - Setiap mailbox mencatat kedalaman antrian dan latensi kirim -> terima;
+ *   lihat perintah 'mbox'.
+ */
+#define MBOX_TEST_DEPTH     16   // Kedalaman mailbox 'mboxbench' (pangkat dua)
+#define MBOX_TEST_MSGS      8    // Buffer pesan di pool 'msgs'
+#define MBOX_TEST_PRIORITY  4    // Penerima di atas shell: tiap pesan langsung diambil
+#define MBOX_TEST_STACK     512
+
+typedef struct Mailbox {
+    const char *name;        // Nama untuk perintah 'mbox'
+    Ring ring;               // Pointer pesan + waktu kirim
+    Semaphore avail;         // Satu unit per pesan di antrian
+    uint32_t received;       // Terkirim = received + isi antrian
+    uint32_t full;           // mbox_send() yang gagal karena antrian penuh
+    uint32_t timeouts;       // mbox_recv_timeout() yang habis waktu
+    uint32_t peak_depth;     // Kedalaman antrian tertinggi
+    uint32_t max_latency;    // Kirim -> terima terlama (siklus)
+    uint64_t total_latency;
+    struct Mailbox *next;    // Daftar semua mailbox
+} Mailbox;
+
+int mbox_create(Mailbox *mb, const char *name, uint32_t depth);
+int mbox_send(Mailbox *mb, void *msg);
+void *mbox_recv(Mailbox *mb);
+void *mbox_recv_timeout(Mailbox *mb, uint32_t ticks);
+void *mbox_tryrecv(Mailbox *mb);
+uint32_t mbox_count(const Mailbox *mb);
+void mbox_print_stats(void);
+void mbox_test(uint32_t count);
+
+#endif // __MBOX_H_
@@ -0,0 +1,220 @@
+#include "reg.h"
+#include "cpu.h"
+#include "nvic.h"
+#include "sysclk.h"
+
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+#define NVIC_LATENCY_CAL_RUNS  16      // Runs used to measure the timestamp overhead
+#define NVIC_LATENCY_SPIN_MAX  100000  // Polls before giving up on a probe that never fires
+
+// Written by the probe handler: SysTick counter on entry and number of entries.
+static volatile uint32_t latency_isr_cvr;
+static volatile uint32_t latency_isr_hits;
+
+/**
+ * @brief Returns 1 if 'irq' is a peripheral interrupt in the vector table.
+ */
+static int nvic_valid_irq(int irq)
+{
+    return irq >= 0 && irq < IRQ_COUNT;
+}
+
+/**
+ * @brief Enables a peripheral interrupt line.
+ */
+void nvic_enable_irq(int irq)
+{
+    if (!nvic_valid_irq(irq)) return;
+    NVIC_EN0[irq >> 5] = 1u << (irq & 31);
+}
+
+/**
+ * @brief Disables a peripheral interrupt line.
+ *
+ * The barriers guarantee the handler cannot run after this returns, even if
+ * the interrupt was already pending.
+ */
+void nvic_disable_irq(int irq)
+{
+    if (!nvic_valid_irq(irq)) return;
+    NVIC_DIS0[irq >> 5] = 1u << (irq & 31);
+    cpu_dsb();
+    cpu_isb();
+}
+
+/**
+ * @brief Marks a peripheral interrupt as pending (software-triggered).
+ */
+void nvic_set_pending(int irq)
+{
+    if (!nvic_valid_irq(irq)) return;
+    NVIC_PEND0[irq >> 5] = 1u << (irq & 31);
+}
+
+/**
+ * @brief Clears the pending state of a peripheral interrupt.
+ */
+void nvic_clear_pending(int irq)
+{
+    if (!nvic_valid_irq(irq)) return;
+    NVIC_UNPEND0[irq >> 5] = 1u << (irq & 31);
+}
+
+/**
+ * @brief Returns 1 if the interrupt line is enabled.
+ */
+int nvic_is_enabled(int irq)
+{
+    if (!nvic_valid_irq(irq)) return 0;
+    return (NVIC_EN0[irq >> 5] >> (irq & 31)) & 1;
+}
+
+/**
+ * @brief Returns 1 if the interrupt is pending.
+ */
+int nvic_is_pending(int irq)
+{
+    if (!nvic_valid_irq(irq)) return 0;
+    return (NVIC_PEND0[irq >> 5] >> (irq & 31)) & 1;
+}
+
+/**
+ * @brief Returns 1 if the interrupt handler is running or preempted.
+ */
+int nvic_is_active(int irq)
+{
+    if (!nvic_valid_irq(irq)) return 0;
+    return (NVIC_ACTIVE0[irq >> 5] >> (irq & 31)) & 1;
+}
+
+/**
+ * @brief Sets the priority of a peripheral interrupt or system exception.
+ *
+ * Only the top NVIC_PRIO_BITS bits of each priority byte are implemented, so
+ * the logical priority is shifted into place.
+ * @param irq      Peripheral IRQ number, or a negative system exception number.
+ * @param priority 0 (highest) to NVIC_PRIO_LOWEST; larger values are clamped.
+ */
+void nvic_set_priority(int irq, uint32_t priority)
+{
+    if (priority > NVIC_PRIO_LOWEST) {
+        priority = NVIC_PRIO_LOWEST;
+    }
+    uint8_t value = (uint8_t)(priority << (8 - NVIC_PRIO_BITS));
+
+    if (irq < 0) {
+        // Exception number = irq + 16; SHPR starts at exception 4 (MemManage).
+        if (irq >= IRQ_MEMMANAGE) {
+            SCB_SHPR[irq + 16 - 4] = value;
+        }
+    } else if (nvic_valid_irq(irq)) {
+        NVIC_PRI[irq] = value;
+    }
+}
+
+/**
+ * @brief Returns the logical priority set by nvic_set_priority().
+ */
+uint32_t nvic_get_priority(int irq)
+{
+    if (irq < 0) {
+        if (irq < IRQ_MEMMANAGE) return 0;
+        return SCB_SHPR[irq + 16 - 4] >> (8 - NVIC_PRIO_BITS);
+    }
+    if (!nvic_valid_irq(irq)) return 0;
+    return NVIC_PRI[irq] >> (8 - NVIC_PRIO_BITS);
+}
+
+/**
+ * @brief Latency probe: overrides the weak System Control vector (NVIC_LATENCY_IRQ).
+ *
+ * Reading SysTick is the first thing it does, so the measured time covers the
+ * exception entry (stacking, vector fetch) plus the handler prologue.
+ */
+RAMFUNC void sysctl_isr(void)
+{
+    latency_isr_cvr = *(SYST_CVR);
+    latency_isr_hits++;
+}
+
+/**
+ * @brief Cycles between two reads of the SysTick down-counter, allowing one wrap.
+ */
+static uint32_t systick_elapsed(uint32_t from, uint32_t to, uint32_t reload)
+{
+    return (from >= to) ? from - to : from + reload - to;
+}
+
+/**
+ * @brief Measures interrupt entry latency and jitter ('irqlat' command).
+ *
+ * Each sample reads SysTick, software-triggers NVIC_LATENCY_IRQ through the
+ * STIR register and compares with the value read on handler entry. The cost of
+ * taking the timestamp itself (two back-to-back reads) is subtracted. Other
+ * interrupts stay enabled, so preemption by SysTick or UART shows up as jitter.
+ * @param samples Number of measurements.
+ */
+void nvic_latency_test(uint32_t samples)
+{
+    char num[12];
+    uint32_t reload = *(SYST_RVR) + 1;
+    uint32_t overhead = 0xFFFFFFFF;
+    uint32_t min = 0xFFFFFFFF, max = 0, taken = 0;
+    uint64_t sum = 0;
+
+    if (samples == 0) return;
+    if (irq_disabled() || cpu_ipsr() != 0) {
+        print_str("Error: irqlat needs interrupts enabled in Thread mode.\n");
+        return;
+    }
+
+    for (int i = 0; i < NVIC_LATENCY_CAL_RUNS; i++) {
+        uint32_t a = *(SYST_CVR);
+        uint32_t b = *(SYST_CVR);
+        uint32_t d = systick_elapsed(a, b, reload);
+        if (d < overhead) overhead = d;
+    }
+
+    nvic_set_priority(NVIC_LATENCY_IRQ, 0);
+    nvic_clear_pending(NVIC_LATENCY_IRQ);
+    nvic_enable_irq(NVIC_LATENCY_IRQ);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        uint32_t hits = latency_isr_hits;
+        uint32_t spins = 0;
+
+        uint32_t start = *(SYST_CVR);
+        *(NVIC_SW_TRIG) = NVIC_LATENCY_IRQ;
+        while (latency_isr_hits == hits && ++spins < NVIC_LATENCY_SPIN_MAX);
+        if (latency_isr_hits == hits) {
+            break;
+        }
+
+        uint32_t d = systick_elapsed(start, latency_isr_cvr, reload);
+        d = (d > overhead) ? d - overhead : 0;
+        if (d < min) min = d;
+        if (d > max) max = d;
+        sum += d;
+        taken++;
+    }
+
+    nvic_disable_irq(NVIC_LATENCY_IRQ);
+    nvic_clear_pending(NVIC_LATENCY_IRQ);
+
+    if (taken == 0) {
+        print_str("Error: latency probe IRQ never fired.\n");
+        return;
+    }
+
+    uint32_t mhz = sysclk_get_hz() / 1000000;
+    print_str("IRQ entry latency ("); itoa(taken, num); print_str(num);
+    print_str(" samples, IRQ "); itoa(NVIC_LATENCY_IRQ, num); print_str(num); print_str("):\n");
+    print_str("  Min: "); itoa(min, num); print_str(num); print_str(" cycles\n");
+    print_str("  Max: "); itoa(max, num); print_str(num); print_str(" cycles\n");
+    print_str("  Avg: "); itoa((uint32_t)(sum / taken), num); print_str(num); print_str(" cycles\n");
+    print_str("  Jitter: "); itoa(max - min, num); print_str(num); print_str(" cycles\n");
+    print_str("  Min at "); itoa(mhz, num); print_str(num); print_str(" MHz: ");
+    itoa(min * 1000 / mhz, num); print_str(num); print_str(" ns\n");
+}
@@ -0,0 +1,30 @@
+#ifndef __NVIC_H_
+#define __NVIC_H_
+
+#include <stdint.h>
+
+/*
+ * Driver NVIC (Nested Vectored Interrupt Controller).
+ * Nomor IRQ mengikuti reg.h: 0..IRQ_COUNT-1 untuk peripheral, nilai negatif
+ * (IRQ_PENDSV, IRQ_SYSTICK, ...) untuk exception sistem dan hanya berlaku
+ * untuk nvic_set_priority()/nvic_get_priority().
+ * Prioritas logis 0 (tertinggi) .. NVIC_PRIO_LOWEST (terendah).
+ */
+
+// IRQ yang dipakai sebagai probe untuk 'irqlat'. System Control (PLL lock,
+// brown-out) tidak dipakai driver mana pun, jadi vector-nya dipinjam di sini.
+#define NVIC_LATENCY_IRQ    IRQ_SYSCTL
+
+void nvic_enable_irq(int irq);
+void nvic_disable_irq(int irq);
+void nvic_set_pending(int irq);
+void nvic_clear_pending(int irq);
+int nvic_is_enabled(int irq);
+int nvic_is_pending(int irq);
+int nvic_is_active(int irq);
+void nvic_set_priority(int irq, uint32_t priority);
+uint32_t nvic_get_priority(int irq);
+
+void nvic_latency_test(uint32_t samples);
+
+#endif // __NVIC_H_
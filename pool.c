@@ -0,0 +1,172 @@
+#include "pool.h"
+#include "cpu.h" // For irq_save()/irq_restore()
+#include "log.h"
+
+void *malloc(size_t size);
+void free(void *ptr);
+void *memset(void *s, int c, size_t n);
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+// All pools ever created, newest first. Walked by pool_print_stats().
+static Pool *pool_list;
+
+/**
+ * @brief Creates a pool of 'count' objects of 'obj_size' bytes each.
+ *
+ * The objects and the in-use bitmap are carved out of a single heap block,
+ * so the general allocator pays one BlockHeader for the whole pool.
+ * @param pool     Caller-owned control block (usually a static variable).
+ * @param name     Name shown by the 'pools' shell command.
+ * @param obj_size Size of one object in bytes.
+ * @param count    Number of objects.
+ * @return 0 on success, -1 if the arguments are invalid or the heap is full.
+ */
+int pool_create(Pool *pool, const char *name, size_t obj_size, size_t count)
+{
+    if (pool == NULL || obj_size == 0 || count == 0 || count > 0xFFFF) {
+        return -1;
+    }
+
+    // Every free object must be able to hold the free-list link.
+    if (obj_size < sizeof(void *)) {
+        obj_size = sizeof(void *);
+    }
+    obj_size = (obj_size + 3) & ~3u;
+    if (obj_size > 0xFFFF) {
+        return -1;
+    }
+
+    size_t map_bytes = (count + 7) / 8;
+    uint8_t *mem = malloc(obj_size * count + map_bytes);
+    if (mem == NULL) {
+        return -1;
+    }
+
+    pool->name = name;
+    pool->base = mem;
+    pool->used_map = mem + obj_size * count;
+    pool->obj_size = (uint16_t)obj_size;
+    pool->count = (uint16_t)count;
+    pool->used = 0;
+    pool->peak = 0;
+    pool->fails = 0;
+    memset(pool->used_map, 0, map_bytes);
+
+    // Thread the free list through the objects in address order.
+    pool->free_head = NULL;
+    for (size_t i = count; i > 0; i--) {
+        void **obj = (void **)(mem + (i - 1) * obj_size);
+        *obj = pool->free_head;
+        pool->free_head = obj;
+    }
+
+    uint32_t primask = irq_save();
+    pool->next = pool_list;
+    pool_list = pool;
+    irq_restore(primask);
+    return 0;
+}
+
+/**
+ * @brief Unregisters a pool and returns its memory to the heap.
+ *        Any objects still allocated from it become invalid.
+ */
+void pool_destroy(Pool *pool)
+{
+    uint32_t primask = irq_save();
+    for (Pool **p = &pool_list; *p != NULL; p = &(*p)->next) {
+        if (*p == pool) {
+            *p = pool->next;
+            break;
+        }
+    }
+    irq_restore(primask);
+
+    free(pool->base);
+    pool->base = NULL;
+    pool->free_head = NULL;
+    pool->count = 0;
+}
+
+/**
+ * @brief Takes one object from the pool in O(1). Safe to call from an ISR.
+ * @return Pointer to the object, or NULL if the pool is exhausted.
+ */
+void *pool_alloc(Pool *pool)
+{
+    uint32_t primask = irq_save();
+    void **obj = pool->free_head;
+    if (obj == NULL) {
+        pool->fails++;
+        irq_restore(primask);
+        return NULL;
+    }
+    pool->free_head = *obj;
+
+    uint32_t index = ((uint8_t *)obj - pool->base) / pool->obj_size;
+    pool->used_map[index >> 3] |= (uint8_t)(1 << (index & 7));
+    pool->used++;
+    if (pool->used > pool->peak) {
+        pool->peak = pool->used;
+    }
+    irq_restore(primask);
+    return obj;
+}
+
+/**
+ * @brief Returns an object to its pool in O(1). Safe to call from an ISR.
+ *
+ * Rejects pointers that are outside the pool, not on an object boundary, or
+ * already free.
+ */
+void pool_free(Pool *pool, void *obj)
+{
+    if (obj == NULL) return;
+
+    uint32_t offset = (uint8_t *)obj - pool->base;
+    if ((uint8_t *)obj < pool->base || offset >= (uint32_t)pool->obj_size * pool->count
+        || offset % pool->obj_size != 0) {
+        LOG_ERROR(POOL, "Pointer %p does not belong to pool '%s'!\n", obj, pool->name);
+        return;
+    }
+
+    uint32_t index = offset / pool->obj_size;
+    uint8_t bit = (uint8_t)(1 << (index & 7));
+
+    uint32_t primask = irq_save();
+    if ((pool->used_map[index >> 3] & bit) == 0) {
+        irq_restore(primask);
+        LOG_WARN(POOL, "Pool '%s' double-free of %p detected!\n", pool->name, obj);
+        return;
+    }
+    pool->used_map[index >> 3] &= (uint8_t)~bit;
+    *(void **)obj = pool->free_head;
+    pool->free_head = obj;
+    pool->used--;
+    irq_restore(primask);
+}
+
+/**
+ * @brief Prints usage statistics of every registered pool ('pools' command).
+ */
+void pool_print_stats(void)
+{
+    char num[12];
+
+    if (pool_list == NULL) {
+        print_str("No pools created.\n");
+        return;
+    }
+
+    print_str("Object pools:\n");
+    for (Pool *p = pool_list; p != NULL; p = p->next) {
+        print_str("  "); print_str(p->name);
+        print_str(" | Obj: "); itoa(p->obj_size, num); print_str(num);
+        print_str(" | Used: "); itoa(p->used, num); print_str(num);
+        print_str("/"); itoa(p->count, num); print_str(num);
+        print_str(" | Peak: "); itoa(p->peak, num); print_str(num);
+        print_str(" | Fails: "); itoa(p->fails, num); print_str(num);
+        print_str("\n");
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef __POOL_H_
+#define __POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Fixed-size object pool (slab) allocator.
+ * Satu pool = satu potongan memori dari heap yang dibagi menjadi 'count' objek
+ * berukuran sama. Objek bebas dirangkai dalam free list di dalam objek itu
+ * sendiri, jadi alloc/free O(1) tanpa BlockHeader per objek.
+ */
+typedef struct Pool {
+    const char *name;       // Nama untuk perintah 'pools'
+    uint8_t *base;          // Awal area objek (hasil malloc)
+    uint8_t *used_map;      // Bitmap objek terpakai, untuk deteksi double free
+    void *free_head;        // Objek bebas pertama
+    uint16_t obj_size;      // Ukuran objek setelah dibulatkan ke 4 byte
+    uint16_t count;         // Jumlah objek di pool
+    uint16_t used;          // Objek yang sedang dipakai
+    uint16_t peak;          // Nilai 'used' tertinggi
+    uint32_t fails;         // pool_alloc() yang gagal karena pool habis
+    struct Pool *next;      // Daftar semua pool yang terdaftar
+} Pool;
+
+int pool_create(Pool *pool, const char *name, size_t obj_size, size_t count);
+void pool_destroy(Pool *pool);
+void *pool_alloc(Pool *pool);
+void pool_free(Pool *pool, void *obj);
+void pool_print_stats(void);
+
+#endif // __POOL_H_
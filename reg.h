@@ -25,6 +25,26 @@
         // SYSCTL mengontrol clock, reset, dan fungsi sistem dasar lainnya untuk LM3S6965.
         #define SYSCTL_BASE         ((__REG_TYPE)0x400FE000) // Alamat dasar untuk modul SYSCTL
         #define SYSCTL_RCGC2        ((__REG)(SYSCTL_BASE + 0x108)) // Run Mode Clock Gating Control Register 2 (untuk GPIO)
+        #define SYSCTL_RIS          ((__REG)(SYSCTL_BASE + 0x050)) // Raw Interrupt Status (berisi flag PLL lock)
+        #define SYSCTL_MISC         ((__REG)(SYSCTL_BASE + 0x058)) // Masked Interrupt Status and Clear (tulis 1 untuk menghapus)
+        #define SYSCTL_RCC          ((__REG)(SYSCTL_BASE + 0x060)) // Run-Mode Clock Configuration
+        #define SYSCTL_RCC2         ((__REG)(SYSCTL_BASE + 0x070)) // Run-Mode Clock Configuration 2
+
+        // Bit-bit SYSCTL_RCC (Datasheet LM3S6965, bagian "System Control", register RCC)
+        #define SYSCTL_RCC_MOSCDIS      (1 << 0)      // Main Oscillator Disable
+        #define SYSCTL_RCC_OSCSRC_MASK  (0x3 << 4)    // Oscillator Source
+        #define SYSCTL_RCC_OSCSRC_MAIN  (0x0 << 4)    // Sumber: main oscillator (kristal)
+        #define SYSCTL_RCC_XTAL_MASK    (0xF << 6)    // Nilai kristal yang terpasang
+        #define SYSCTL_RCC_XTAL_8MHZ    (0xE << 6)    // Kristal 8 MHz (terpasang di board LM3S6965evb)
+        #define SYSCTL_RCC_BYPASS       (1 << 11)     // PLL Bypass (clock langsung dari osilator)
+        #define SYSCTL_RCC_PWRDN        (1 << 13)     // PLL Power Down
+        #define SYSCTL_RCC_USESYSDIV    (1 << 22)     // Gunakan pembagi SYSDIV
+        #define SYSCTL_RCC_SYSDIV_MASK  (0xF << 23)   // System Clock Divisor
+        #define SYSCTL_RCC_SYSDIV_SHIFT 23
+
+        #define SYSCTL_RCC2_USERCC2     (1u << 31)    // Jika 1, RCC2 menimpa field di RCC
+        #define SYSCTL_RIS_PLLLRIS      (1 << 6)      // PLL Lock Raw Interrupt Status
+        #define SYSCTL_MISC_PLLLMIS     (1 << 6)      // Tulis 1 untuk menghapus flag PLL lock
 
         // Definisi Clock Enable untuk GPIO Port A dari RCGC2
         #define SYSCTL_RCGC2_GPIOA  (1 << 0)  // Clock Enable for GPIO Port A (Bit 0)
@@ -36,11 +56,11 @@
         #define SYSCTL_RCGCUART ((__REG)(SYSCTL_RCGCUART_BASE))
         #define SYSCTL_RCGCUART_UART0 (1 << 0) // Clock Enable for UART0 (Bit 0 of RCGCUART)
 
-        // Definisi untuk mengaktifkan clock Timer0 (SYSCTL_RCGC1) - JIKA NANTI DIBUTUHKAN
+        // Definisi untuk mengaktifkan clock Timer0 (SYSCTL_RCGC1), dipakai oleh timer.c
         // Datasheet page 220, offset 0x104 dari SYSCTL_BASE
         #define SYSCTL_RCGC1_BASE   ((__REG_TYPE)0x400FE104) // Alamat dasar untuk RCGC1
         #define SYSCTL_RCGC1        ((__REG)(SYSCTL_RCGC1_BASE))
-        #define SYSCTL_RCGC1_TIMER0 (1 << 0)  // Clock Enable for Timer0 (Bit 0 of RCGC1)
+        #define SYSCTL_RCGC1_TIMER0 (1 << 16) // Clock Enable for Timer0 (Bit 16 of RCGC1; bit 0 adalah UART0)
 
 
         /* GPIO Memory Map */
@@ -72,9 +92,26 @@
         #define UART0_DMACR         ((__REG)(UART0_BASE + 0x048)) // DMA Control Register
         #define UART0_CC            ((__REG)(UART0_BASE + 0xFC8)) // Clock Configuration Register (untuk memilih sumber clock UART)
 
+        /* Bit definitions for UART0_DR (Data Register), bit 8-11 berisi status error per karakter */
+        #define UART0_DR_OE         (1 << 11) // Overrun Error: FIFO hardware penuh, ada karakter yang hilang
+
         /* Bit definitions for UART0_FR (Flag Register) */
         #define UART0_FR_TXFF       (1 << 5) // Transmit FIFO Full: Bit 5 (FIFO penuh, tidak bisa kirim lagi)
         #define UART0_FR_RXFE       (1 << 4) // Receive FIFO Empty: Bit 4 (FIFO kosong, tidak ada data diterima)
+        #define UART0_FR_TXFE       (1 << 7) // Transmit FIFO Empty: Bit 7 (FIFO kirim kosong)
+        #define UART0_FR_BUSY       (1 << 3) // UART Busy: Bit 3 (masih mengirim data, termasuk shift register)
+
+        /* Bit definitions for UART0_IM / UART0_RIS / UART0_MIS / UART0_ICR (Interrupt) */
+        // Posisi bit sama untuk keempat register: mask, raw status, masked status, dan clear.
+        #define UART0_INT_RX        (1 << 4) // Receive interrupt (level FIFO terima melewati ambang)
+        #define UART0_INT_TX        (1 << 5) // Transmit interrupt (level FIFO kirim turun melewati ambang)
+        #define UART0_INT_RT        (1 << 6) // Receive Time-Out interrupt
+
+        /* Bit definitions for UART0_IFLS (Interrupt FIFO Level Select) */
+        #define UART0_IFLS_TX_1_8   (0x0 << 0) // TX interrupt saat FIFO <= 1/8 penuh
+        #define UART0_IFLS_TX_1_2   (0x2 << 0) // TX interrupt saat FIFO <= 1/2 penuh
+        #define UART0_IFLS_RX_1_8   (0x0 << 3) // RX interrupt saat FIFO >= 1/8 penuh
+        #define UART0_IFLS_RX_1_2   (0x2 << 3) // RX interrupt saat FIFO >= 1/2 penuh
 
         /* Bit definitions for UART0_LCRH (Line Control Register, High) */
         #define UART0_LCRH_WLEN_8   (0x3 << 5) // Word Length 8-bit: Bit 5-6 set ke 0b11
@@ -86,6 +123,93 @@
         #define UART0_CTL_RXE       (1 << 9)   // Receive Enable: Bit 9 (mengaktifkan receiver)
 
 
+        /* ============================================================================
+         * NVIC (Nested Vectored Interrupt Controller) - bagian dari inti Cortex-M3
+         * Setiap register EN/DIS/PEND mencakup 32 IRQ; LM3S6965 hanya memakai IRQ 0-43.
+         * ============================================================================
+         */
+        #define NVIC_EN0            ((__REG)0xE000E100) // Interrupt Set Enable (IRQ 0-31, EN1 = NVIC_EN0[1])
+        #define NVIC_DIS0           ((__REG)0xE000E180) // Interrupt Clear Enable (IRQ 0-31)
+        #define NVIC_PEND0          ((__REG)0xE000E200) // Interrupt Set Pending (IRQ 0-31)
+        #define NVIC_UNPEND0        ((__REG)0xE000E280) // Interrupt Clear Pending (IRQ 0-31)
+        #define NVIC_ACTIVE0        ((__REG)0xE000E300) // Interrupt Active Bit (IRQ 0-31, read-only)
+        #define NVIC_PRI            ((volatile uint8_t *)0xE000E400) // Prioritas IRQ, 1 byte per IRQ
+        #define NVIC_SW_TRIG        ((__REG)0xE000EF00) // Software Trigger Interrupt (tulis nomor IRQ)
+        #define SCB_SHPR            ((volatile uint8_t *)0xE000ED18) // Prioritas system handler, 1 byte per exception 4-15
+
+        // LM3S6965 hanya mengimplementasikan 3 bit teratas dari byte prioritas (0 = tertinggi, 7 = terendah)
+        #define NVIC_PRIO_BITS      3
+        #define NVIC_PRIO_LOWEST    ((1 << NVIC_PRIO_BITS) - 1)
+
+        // Nomor exception sistem (negatif, gaya CMSIS: nomor exception - 16), hanya untuk prioritas
+        #define IRQ_MEMMANAGE       (-12)
+        #define IRQ_BUSFAULT        (-11)
+        #define IRQ_USAGEFAULT      (-10)
+        #define IRQ_SVCALL          (-5)
+        #define IRQ_DEBUGMON        (-4)
+        #define IRQ_PENDSV          (-2)
+        #define IRQ_SYSTICK         (-1)
+
+        // Nomor IRQ peripheral (posisi di vector table = 16 + nomor IRQ)
+        #define IRQ_GPIOA           0
+        #define IRQ_GPIOB           1
+        #define IRQ_GPIOC           2
+        #define IRQ_GPIOD           3
+        #define IRQ_GPIOE           4
+        #define IRQ_UART0           5
+        #define IRQ_UART1           6
+        #define IRQ_SSI0            7
+        #define IRQ_I2C0            8
+        #define IRQ_PWM_FAULT       9
+        #define IRQ_PWM_GEN0        10
+        #define IRQ_PWM_GEN1        11
+        #define IRQ_PWM_GEN2        12
+        #define IRQ_QEI0            13
+        #define IRQ_ADC0_SS0        14
+        #define IRQ_ADC0_SS1        15
+        #define IRQ_ADC0_SS2        16
+        #define IRQ_ADC0_SS3        17
+        #define IRQ_WATCHDOG        18
+        #define IRQ_TIMER0A         19
+        #define IRQ_TIMER0B         20
+        #define IRQ_TIMER1A         21
+        #define IRQ_TIMER1B         22
+        #define IRQ_TIMER2A         23
+        #define IRQ_TIMER2B         24
+        #define IRQ_COMP0           25
+        #define IRQ_COMP1           26
+        #define IRQ_SYSCTL          28
+        #define IRQ_FLASH           29
+        #define IRQ_GPIOF           30
+        #define IRQ_GPIOG           31
+        #define IRQ_UART2           33
+        #define IRQ_TIMER3A         35
+        #define IRQ_TIMER3B         36
+        #define IRQ_I2C1            37
+        #define IRQ_QEI1            38
+        #define IRQ_ETHERNET        42
+        #define IRQ_HIBERNATE       43
+        #define IRQ_COUNT           44 // Jumlah entri IRQ di vector table (termasuk yang reserved)
+
+        /* ============================================================================
+         * SysTick - timer 24-bit hitung mundur bawaan inti Cortex-M3
+         * ============================================================================
+         */
+        #define SYST_CSR            ((__REG)0xE000E010) // SysTick Control and Status Register
+        #define SYST_RVR            ((__REG)0xE000E014) // SysTick Reload Value Register
+        #define SYST_CVR            ((__REG)0xE000E018) // SysTick Current Value Register
+
+        #define SYST_CSR_ENABLE     (1 << 0)   // Counter Enable
+        #define SYST_CSR_TICKINT    (1 << 1)   // Interrupt saat counter mencapai 0
+        #define SYST_CSR_CLKSOURCE  (1 << 2)   // 1 = clock inti (processor clock)
+        #define SYST_CSR_COUNTFLAG  (1 << 16)  // 1 jika counter mencapai 0 sejak dibaca terakhir
+        #define SYST_RVR_MAX        0x00FFFFFF // Nilai reload maksimum (24-bit)
+
+        /* SCB (System Control Block) */
+        #define SCB_ICSR            ((__REG)0xE000ED04) // Interrupt Control and State Register
+        #define SCB_ICSR_PENDSTSET  (1 << 26)  // SysTick exception pending
+        #define SCB_ICSR_PENDSVSET  (1 << 28)  // Set-pending PendSV (dipakai untuk context switch)
+
         /* ============================================================================
          * Definisi Register Timer0 (General-Purpose Timer Module)
          * LM3S6965 memiliki 4 GPTM (Timer0-Timer3). Kita akan gunakan Timer0.
@@ -115,6 +239,9 @@
         // GPTM Control Register (GPTMCTL)
         #define GPTM_CTL_TAEN         (1 << 0)   // Timer A Enable (Bit 0)
 
+        // GPTM Interrupt Mask Register (GPTMIMR)
+        #define GPTM_IMR_TATOIM       (1 << 0)   // TimerA Time-Out Interrupt Mask (Bit 0)
+
         // GPTM Raw Interrupt Status Register (GPTMRIS)
         #define GPTM_RIS_TATORIS      (1 << 0)   // TimerA Time-Out Raw Interrupt Status (Bit 0)
 
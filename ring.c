@@ -0,0 +1,368 @@
+#include "cpu.h"
+#include "ring.h"
+#include <stddef.h>
+
+void *memcpy(void *dest, const void *src, size_t n);
+
+/**
+ * @brief Copies one element; single bytes (UART data) skip the memcpy call.
+ */
+static inline void ring_copy(void *dst, const void *src, uint32_t size)
+{
+    if (size == 1) {
+        *(uint8_t *)dst = *(const uint8_t *)src;
+    } else {
+        memcpy(dst, src, size);
+    }
+}
+
+/**
+ * @brief Returns the address of the slot for a free-running position.
+ */
+static inline uint8_t *ring_slot(const Ring *r, uint32_t pos)
+{
+    return r->buf + (pos & r->mask) * r->elem_size;
+}
+
+/**
+ * @brief Value of a slot's sequence byte once the element at 'pos' is complete.
+ *
+ * It is the lap number plus one, so the value left by the previous lap (or
+ * the initial 0) never matches.
+ */
+static inline uint8_t ring_seq_ready(const Ring *r, uint32_t pos)
+{
+    return (uint8_t)((pos >> r->shift) + 1);
+}
+
+/**
+ * @brief Initialises a ring over caller-provided storage.
+ * @param buf       capacity * elem_size bytes.
+ * @param seq       capacity bytes for a multi-producer ring, NULL for SPSC.
+ * @param elem_size Size of one element in bytes.
+ * @param capacity  Number of elements; must be a power of two.
+ * @return 0 on success, -1 if the arguments are invalid.
+ */
+int ring_init(Ring *r, void *buf, uint8_t *seq, uint32_t elem_size, uint32_t capacity)
+{
+    if (r == NULL || buf == NULL || elem_size == 0 ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+
+    r->buf = buf;
+    r->seq = seq;
+    r->elem_size = elem_size;
+    r->mask = capacity - 1;
+    r->shift = (uint8_t)(31 - cpu_clz(capacity));
+    r->head = 0;
+    r->tail = 0;
+    if (seq != NULL) {
+        for (uint32_t i = 0; i < capacity; i++) {
+            seq[i] = 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the number of elements the ring can hold.
+ */
+uint32_t ring_capacity(const Ring *r)
+{
+    return r->mask + 1;
+}
+
+/**
+ * @brief Returns the number of queued elements, including MPSC slots that
+ *        are claimed but not committed yet.
+ */
+uint32_t ring_count(const Ring *r)
+{
+    return r->head - r->tail;
+}
+
+/**
+ * @brief Returns the number of free slots.
+ */
+uint32_t ring_space(const Ring *r)
+{
+    return (r->mask + 1) - (r->head - r->tail);
+}
+
+// --- Single producer ---
+
+/**
+ * @brief Appends one element (single producer).
+ * @return 1 on success, 0 if the ring is full.
+ */
+int ring_push(Ring *r, const void *elem)
+{
+    uint32_t head = r->head;
+    if (head - r->tail > r->mask) {
+        return 0;
+    }
+    ring_copy(ring_slot(r, head), elem, r->elem_size);
+    cpu_dmb(); // The element must be visible before the consumer sees the new head.
+    r->head = head + 1;
+    return 1;
+}
+
+/**
+ * @brief Appends up to 'n' elements with at most two copies (single producer).
+ * @return The number of elements queued.
+ */
+uint32_t ring_push_n(Ring *r, const void *src, uint32_t n)
+{
+    uint32_t head = r->head;
+    uint32_t space = (r->mask + 1) - (head - r->tail);
+    if (n > space) {
+        n = space;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    uint32_t first = (r->mask + 1) - (head & r->mask);
+    if (first > n) {
+        first = n;
+    }
+    memcpy(ring_slot(r, head), src, first * r->elem_size);
+    memcpy(r->buf, (const uint8_t *)src + first * r->elem_size, (n - first) * r->elem_size);
+    cpu_dmb();
+    r->head = head + n;
+    return n;
+}
+
+/**
+ * @brief Zero-copy write: returns the free slots that are contiguous in
+ *        memory from the write position (single producer).
+ *
+ * The caller fills up to the returned count at *ptr and publishes them with
+ * ring_write_commit().
+ * @param ptr Receives the address of the first free slot.
+ * @return The number of contiguous free slots, 0 if the ring is full.
+ */
+uint32_t ring_write_reserve(Ring *r, void **ptr)
+{
+    uint32_t head = r->head;
+    uint32_t space = (r->mask + 1) - (head - r->tail);
+    uint32_t to_end = (r->mask + 1) - (head & r->mask);
+
+    *ptr = ring_slot(r, head);
+    return (space < to_end) ? space : to_end;
+}
+
+/**
+ * @brief Publishes 'n' elements written after ring_write_reserve().
+ */
+void ring_write_commit(Ring *r, uint32_t n)
+{
+    cpu_dmb();
+    r->head += n;
+}
+
+// --- Multiple producers ---
+
+/**
+ * @brief Claims up to 'n' slots by advancing head with LDREX/STREX.
+ *
+ * A producer interrupted between the two instructions loses the exclusive
+ * monitor and simply retries, so no one ever waits for another producer.
+ * @param contiguous Also stop at the end of the buffer (for zero-copy).
+ * @param pos        Receives the position of the first claimed slot.
+ * @return The number of slots claimed, 0 if the ring is full.
+ */
+static uint32_t ring_mp_claim(Ring *r, uint32_t n, int contiguous, uint32_t *pos)
+{
+    uint32_t head, count;
+
+    do {
+        head = cpu_ldrex(&r->head);
+        uint32_t space = (r->mask + 1) - (head - r->tail);
+        count = (n < space) ? n : space;
+        if (contiguous) {
+            uint32_t to_end = (r->mask + 1) - (head & r->mask);
+            if (count > to_end) count = to_end;
+        }
+        if (count == 0) {
+            cpu_clrex();
+            return 0;
+        }
+    } while (cpu_strex(head + count, &r->head) != 0);
+
+    *pos = head;
+    return count;
+}
+
+/**
+ * @brief Marks claimed slots as complete so the consumer can take them.
+ */
+static void ring_mp_publish(Ring *r, uint32_t pos, uint32_t count)
+{
+    cpu_dmb(); // Element data before the sequence bytes.
+    for (uint32_t i = 0; i < count; i++, pos++) {
+        r->seq[pos & r->mask] = ring_seq_ready(r, pos);
+    }
+}
+
+/**
+ * @brief Appends one element; safe from any number of tasks and ISRs.
+ * @return 1 on success, 0 if the ring is full.
+ */
+int ring_mp_push(Ring *r, const void *elem)
+{
+    uint32_t pos;
+    if (ring_mp_claim(r, 1, 0, &pos) == 0) {
+        return 0;
+    }
+    ring_copy(ring_slot(r, pos), elem, r->elem_size);
+    ring_mp_publish(r, pos, 1);
+    return 1;
+}
+
+/**
+ * @brief Appends up to 'n' elements as one block; other producers' elements
+ *        never interleave with them.
+ * @return The number of elements queued.
+ */
+uint32_t ring_mp_push_n(Ring *r, const void *src, uint32_t n)
+{
+    uint32_t pos;
+    uint32_t count = ring_mp_claim(r, n, 0, &pos);
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t first = (r->mask + 1) - (pos & r->mask);
+    if (first > count) {
+        first = count;
+    }
+    memcpy(ring_slot(r, pos), src, first * r->elem_size);
+    memcpy(r->buf, (const uint8_t *)src + first * r->elem_size, (count - first) * r->elem_size);
+    ring_mp_publish(r, pos, count);
+    return count;
+}
+
+/**
+ * @brief Zero-copy write: claims up to 'n' slots contiguous in memory.
+ *
+ * Fewer are returned at the end of the buffer or when the ring is nearly
+ * full. The slots belong to the caller until ring_mp_commit(); the consumer
+ * stops at them meanwhile, so keep the window short.
+ * @param slot Receives the address, position and count of the claimed slots.
+ * @return The number of slots claimed, 0 if the ring is full.
+ */
+uint32_t ring_mp_reserve(Ring *r, uint32_t n, RingSlot *slot)
+{
+    uint32_t pos = 0;
+    uint32_t count = ring_mp_claim(r, n, 1, &pos);
+
+    slot->ptr = ring_slot(r, pos);
+    slot->pos = pos;
+    slot->count = count;
+    return count;
+}
+
+/**
+ * @brief Publishes every slot of a reservation from ring_mp_reserve().
+ */
+void ring_mp_commit(Ring *r, const RingSlot *slot)
+{
+    ring_mp_publish(r, slot->pos, slot->count);
+}
+
+// --- Consumer ---
+
+/**
+ * @brief Counts the complete elements from the read position, up to 'limit'.
+ *
+ * For an MPSC ring this stops at the first slot whose producer has not
+ * committed yet, even if later slots are complete.
+ */
+static uint32_t ring_ready(const Ring *r, uint32_t limit)
+{
+    uint32_t tail = r->tail;
+    uint32_t avail = r->head - tail;
+    if (avail > limit) {
+        avail = limit;
+    }
+    if (r->seq == NULL) {
+        return avail;
+    }
+
+    uint32_t n = 0;
+    while (n < avail && r->seq[(tail + n) & r->mask] == ring_seq_ready(r, tail + n)) {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Removes the oldest element.
+ * @return 1 on success, 0 if no complete element is queued.
+ */
+int ring_pop(Ring *r, void *elem)
+{
+    if (ring_ready(r, 1) == 0) {
+        return 0;
+    }
+    cpu_dmb();
+    uint32_t tail = r->tail;
+    ring_copy(elem, ring_slot(r, tail), r->elem_size);
+    cpu_dmb(); // Finish reading the slot before a producer may reuse it.
+    r->tail = tail + 1;
+    return 1;
+}
+
+/**
+ * @brief Removes up to 'n' elements with at most two copies.
+ * @return The number of elements removed.
+ */
+uint32_t ring_pop_n(Ring *r, void *dst, uint32_t n)
+{
+    n = ring_ready(r, n);
+    if (n == 0) {
+        return 0;
+    }
+    cpu_dmb();
+
+    uint32_t tail = r->tail;
+    uint32_t first = (r->mask + 1) - (tail & r->mask);
+    if (first > n) {
+        first = n;
+    }
+    memcpy(dst, ring_slot(r, tail), first * r->elem_size);
+    memcpy((uint8_t *)dst + first * r->elem_size, r->buf, (n - first) * r->elem_size);
+    cpu_dmb();
+    r->tail = tail + n;
+    return n;
+}
+
+/**
+ * @brief Zero-copy read: returns the complete elements that are contiguous in
+ *        memory from the read position.
+ *
+ * The caller reads up to the returned count at *ptr and frees them with
+ * ring_read_release().
+ * @param ptr Receives the address of the oldest element.
+ * @return The number of contiguous elements, 0 if none is ready.
+ */
+uint32_t ring_read_peek(Ring *r, void **ptr)
+{
+    uint32_t tail = r->tail;
+    uint32_t n = ring_ready(r, (r->mask + 1) - (tail & r->mask));
+
+    cpu_dmb();
+    *ptr = ring_slot(r, tail);
+    return n;
+}
+
+/**
+ * @brief Frees 'n' elements read after ring_read_peek().
+ */
+void ring_read_release(Ring *r, uint32_t n)
+{
+    cpu_dmb();
+    r->tail += n;
+}
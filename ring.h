@@ -0,0 +1,60 @@
+#ifndef __RING_H_
+#define __RING_H_
+
+#include <stdint.h>
+
+/*
+ * Ring buffer lock-free untuk jalur data ISR <-> task.
+ * - Kapasitas harus pangkat dua: head/tail berjalan bebas (tidak di-wrap) dan
+ *   indeks slot = posisi & mask, jadi penuh/kosong dibedakan tanpa slot cadangan.
+ * - SPSC (ring_push*, ring_write_*): satu producer dan satu consumer, wait-free,
+ *   tanpa mematikan interrupt. Cukup untuk ISR -> task atau task -> ISR.
+ * - MPSC (ring_mp_*): banyak producer (task dan ISR sekaligus) merebut slot
+ *   dengan LDREX/STREX pada head. Tiap slot punya byte urutan (seq) yang
+ *   ditulis setelah isinya lengkap, sehingga producer yang tertunda di tengah
+ *   penulisan hanya menahan consumer, tidak pernah membuat producer lain
+ *   (mis. ISR) menunggu.
+ * - Fungsi consumer (ring_pop*, ring_read_*) sama untuk kedua jenis; hanya
+ *   boleh dipanggil dari satu konteks pada satu waktu.
+ */
+typedef struct Ring {
+    uint8_t *buf;             // capacity * elem_size byte
+    uint8_t *seq;             // Byte urutan per slot (MPSC), NULL = SPSC
+    uint32_t elem_size;       // Ukuran satu elemen dalam byte
+    uint32_t mask;            // capacity - 1
+    uint8_t shift;            // log2(capacity), untuk nomor putaran di seq
+    volatile uint32_t head;   // Posisi tulis berikutnya (ditulis producer)
+    volatile uint32_t tail;   // Posisi baca berikutnya (ditulis consumer)
+} Ring;
+
+// Reservasi zero-copy MPSC: slot [pos, pos + count) milik pemanggil sampai ring_mp_commit().
+typedef struct RingSlot {
+    void *ptr;
+    uint32_t pos;
+    uint32_t count;
+} RingSlot;
+
+int ring_init(Ring *r, void *buf, uint8_t *seq, uint32_t elem_size, uint32_t capacity);
+uint32_t ring_capacity(const Ring *r);
+uint32_t ring_count(const Ring *r);
+uint32_t ring_space(const Ring *r);
+
+// Producer SPSC
+int ring_push(Ring *r, const void *elem);
+uint32_t ring_push_n(Ring *r, const void *src, uint32_t n);
+uint32_t ring_write_reserve(Ring *r, void **ptr);
+void ring_write_commit(Ring *r, uint32_t n);
+
+// Producer MPSC (ring harus dibuat dengan seq != NULL)
+int ring_mp_push(Ring *r, const void *elem);
+uint32_t ring_mp_push_n(Ring *r, const void *src, uint32_t n);
+uint32_t ring_mp_reserve(Ring *r, uint32_t n, RingSlot *slot);
+void ring_mp_commit(Ring *r, const RingSlot *slot);
+
+// Consumer (SPSC dan MPSC)
+int ring_pop(Ring *r, void *elem);
+uint32_t ring_pop_n(Ring *r, void *dst, uint32_t n);
+uint32_t ring_read_peek(Ring *r, void **ptr);
+void ring_read_release(Ring *r, uint32_t n);
+
+#endif // __RING_H_
@@ -0,0 +1,623 @@
+#include "reg.h"
+#include "cpu.h"
+#include "nvic.h"
+#include "pool.h"
+#include "sched.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "tickless.h"
+#include "sync.h"
+#include "log.h"
+#include "trace.h"
+
+void *malloc(size_t size);
+void free(void *ptr);
+void *memset32(void *s, uint32_t value, size_t count);
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+#define SCHED_STACK_FILL  0xA5A5A5A5u // Pattern for measuring stack usage
+#define XPSR_THUMB        (1u << 24)  // T bit, must be set in the initial xPSR
+
+// Ready bitmap bit for priority p. Priority 0 is the MSB, so CLZ of the
+// bitmap yields the highest ready priority directly.
+#define SCHED_PRIO_BIT(p) (0x80000000u >> (p))
+
+/*
+ * The running task. Not static: pendsv_handler stores the outgoing PSP through
+ * it from assembly.
+ */
+Task *sched_current;
+
+static Task *ready_head[SCHED_PRIORITIES]; // FIFO of READY tasks per priority
+static Task *ready_tail[SCHED_PRIORITIES];
+static uint32_t ready_bitmap;              // Bit set = ready_head[p] is not empty
+static Task *sleep_list;                   // Tasks with a wake_tick, earliest first
+static Task *task_list;                    // Every task, for 'ps' and reaping
+static Pool task_pool;                     // TCB storage
+static uint16_t next_task_id;
+static volatile int sched_started;
+static uint32_t slice_left;                // Ticks left in the current time slice
+static uint64_t switch_in_cycles;          // time_cycles() when sched_current got the CPU
+static uint64_t sched_start_cycles;
+static uint32_t sched_switch_count;
+
+static const char *const task_state_names[] = { "ready", "sleeping", "blocked", "dead" };
+
+/**
+ * @brief Appends a task to the tail of its priority's ready queue.
+ *        Must be called with interrupts disabled.
+ */
+static void ready_push(Task *t)
+{
+    uint32_t p = t->priority;
+    t->next = NULL;
+    t->state = TASK_READY;
+    if (ready_tail[p] != NULL) {
+        ready_tail[p]->next = t;
+    } else {
+        ready_head[p] = t;
+    }
+    ready_tail[p] = t;
+    ready_bitmap |= SCHED_PRIO_BIT(p);
+}
+
+/**
+ * @brief Inserts a task at the head of its priority's ready queue.
+ *        Must be called with interrupts disabled.
+ */
+static void ready_push_front(Task *t)
+{
+    uint32_t p = t->priority;
+    t->state = TASK_READY;
+    t->next = ready_head[p];
+    ready_head[p] = t;
+    if (ready_tail[p] == NULL) {
+        ready_tail[p] = t;
+    }
+    ready_bitmap |= SCHED_PRIO_BIT(p);
+}
+
+/**
+ * @brief Unlinks a task from its ready queue.
+ *
+ * O(1) for the running task, which is always the head of its queue.
+ * Must be called with interrupts disabled.
+ */
+static void ready_remove(Task *t)
+{
+    uint32_t p = t->priority;
+    Task **link = &ready_head[p];
+    Task *prev = NULL;
+
+    while (*link != t) {
+        if (*link == NULL) return;
+        prev = *link;
+        link = &prev->next;
+    }
+    *link = t->next;
+    if (ready_tail[p] == t) {
+        ready_tail[p] = prev;
+    }
+    if (ready_head[p] == NULL) {
+        ready_bitmap &= ~SCHED_PRIO_BIT(p);
+    }
+    t->next = NULL;
+}
+
+/**
+ * @brief Moves the head of a ready queue to its tail (round-robin).
+ *        Must be called with interrupts disabled.
+ */
+static void ready_rotate(uint32_t p)
+{
+    Task *t = ready_head[p];
+    if (t == NULL || t->next == NULL) return;
+    ready_head[p] = t->next;
+    t->next = NULL;
+    ready_tail[p]->next = t;
+    ready_tail[p] = t;
+}
+
+/**
+ * @brief Adds a task to the sleep list, ordered by wake tick.
+ *        Must be called with interrupts disabled.
+ */
+static void sleep_insert(Task *t, uint32_t wake_tick)
+{
+    t->wake_tick = wake_tick;
+    Task **link = &sleep_list;
+    while (*link != NULL && (int32_t)((*link)->wake_tick - wake_tick) <= 0) {
+        link = &(*link)->sleep_next;
+    }
+    t->sleep_next = *link;
+    *link = t;
+    t->in_sleep_list = 1;
+}
+
+/**
+ * @brief Unlinks a task from the sleep list (a timed wait ended early).
+ *        Must be called with interrupts disabled.
+ */
+static void sleep_remove(Task *t)
+{
+    Task **link = &sleep_list;
+    while (*link != NULL && *link != t) {
+        link = &(*link)->sleep_next;
+    }
+    if (*link != NULL) {
+        *link = t->sleep_next;
+    }
+    t->sleep_next = NULL;
+    t->in_sleep_list = 0;
+}
+
+/**
+ * @brief Pends PendSV if the highest-priority ready task is not the running one.
+ *
+ * The switch itself happens once no other exception is active and interrupts
+ * are enabled. Must be called with interrupts disabled.
+ */
+static void sched_reschedule(void)
+{
+    if (!sched_started) return;
+    if (ready_head[cpu_clz(ready_bitmap)] != sched_current) {
+        *(SCB_ICSR) = SCB_ICSR_PENDSVSET;
+    }
+}
+
+/**
+ * @brief Frees the stacks and TCBs of tasks that have exited.
+ *
+ * Runs from task_create() in the caller's context, since a task cannot free
+ * the stack it is still running on.
+ */
+static void sched_reap(void)
+{
+    uint32_t primask = irq_save();
+    Task **link = &task_list;
+    while (*link != NULL) {
+        Task *t = *link;
+        if (t->state == TASK_DEAD && t != sched_current) {
+            *link = t->all_next;
+            irq_restore(primask);
+            free(t->stack_base);
+            pool_free(&task_pool, t);
+            primask = irq_save();
+            link = &task_list;
+            continue;
+        }
+        link = &t->all_next;
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief Idle task: sleeps the core whenever nothing else is ready, with the
+ *        periodic tick suppressed until the next timeout (see tickless.c).
+ */
+static void idle_task_entry(void *arg)
+{
+    (void)arg;
+    while (1) {
+        tickless_idle();
+    }
+}
+
+/**
+ * @brief Picks the next task to run. Called from pendsv_handler with
+ *        interrupts disabled, after the outgoing context has been saved.
+ *
+ * Also charges the elapsed CPU time to the outgoing task.
+ * @return The task whose context pendsv_handler restores.
+ */
+__attribute__((used)) Task *sched_switch(void)
+{
+    uint64_t now = time_cycles();
+    Task *prev = sched_current;
+    if (prev != NULL) {
+        prev->cpu_cycles += now - switch_in_cycles;
+    }
+    switch_in_cycles = now;
+
+    Task *next = ready_head[cpu_clz(ready_bitmap)];
+    if (next != prev) {
+        TRACE(TRACE_EV_SWITCH, prev != NULL ? prev->id : 0xFFFF, next->id);
+        next->switches++;
+        sched_switch_count++;
+        slice_left = SCHED_TIMESLICE_TICKS;
+    }
+    sched_current = next;
+    return next;
+}
+
+/**
+ * @brief PendSV handler: saves r4-r11 of the running task on its stack,
+ *        switches to the task chosen by sched_switch() and restores its context.
+ *
+ * PendSV has the lowest priority, so it only runs once every other handler
+ * has finished. PSP is 0 before the first switch (sched_start() runs on MSP),
+ * in which case there is no context to save.
+ */
+__attribute__((naked)) void pendsv_handler(void)
+{
+    __asm__ volatile (
+        "cpsid i                \n"
+        "mrs   r0, psp          \n"
+        "cbz   r0, 1f           \n"
+        "stmdb r0!, {r4-r11}    \n"
+        "ldr   r1, =sched_current \n"
+        "ldr   r1, [r1]         \n"
+        "str   r0, [r1]         \n" // sched_current->sp = PSP
+        "1:                     \n"
+        "push  {r3, lr}         \n"
+        "bl    sched_switch     \n" // r0 = next task
+        "pop   {r3, lr}         \n"
+        "ldr   r0, [r0]         \n"
+        "ldmia r0!, {r4-r11}    \n"
+        "msr   psp, r0          \n"
+        "cpsie i                \n"
+        "ldr   lr, =0xFFFFFFFD  \n" // Return to Thread mode on PSP
+        "bx    lr               \n"
+        ".ltorg                 \n"
+    );
+}
+
+/**
+ * @brief Creates the TCB pool and the idle task. Call once before task_create().
+ */
+void sched_init(void)
+{
+    pool_create(&task_pool, "tasks", sizeof(Task), SCHED_MAX_TASKS);
+    task_create("idle", idle_task_entry, NULL, SCHED_PRIO_IDLE, SCHED_IDLE_STACK);
+}
+
+/**
+ * @brief Starts multitasking by switching to the highest-priority ready task.
+ *        Never returns; the calling context (main() on MSP) is abandoned.
+ */
+void sched_start(void)
+{
+    nvic_set_priority(IRQ_PENDSV, NVIC_PRIO_LOWEST);
+
+    irq_save();
+    cpu_set_psp(0);
+    sched_current = NULL;
+    sched_start_cycles = time_cycles();
+    switch_in_cycles = sched_start_cycles;
+    slice_left = SCHED_TIMESLICE_TICKS;
+    sched_started = 1;
+    *(SCB_ICSR) = SCB_ICSR_PENDSVSET;
+    irq_restore(0); // PendSV runs here and switches to the first task.
+
+    while (1);
+}
+
+/**
+ * @brief Returns 1 once sched_start() has handed the CPU to the tasks.
+ */
+int sched_running(void)
+{
+    return sched_started;
+}
+
+/**
+ * @brief Scheduler tick, called from the SysTick handler.
+ *
+ * Wakes sleeping tasks whose deadline has passed, ends timed waits that ran
+ * out (the task sees timed_out set) and rotates the running
+ * task's priority level when its time slice runs out.
+ */
+void sched_tick(void)
+{
+    if (!sched_started) return;
+
+    uint32_t primask = irq_save();
+    uint32_t now = time_ticks();
+    while (sleep_list != NULL && (int32_t)(now - sleep_list->wake_tick) >= 0) {
+        Task *t = sleep_list;
+        sleep_list = t->sleep_next;
+        t->in_sleep_list = 0;
+        if (t->state == TASK_BLOCKED) {
+            t->timed_out = 1;
+            sync_cancel_wait(t);
+        }
+        ready_push(t);
+    }
+
+    if (--slice_left == 0) {
+        slice_left = SCHED_TIMESLICE_TICKS;
+        if (sched_current != NULL && sched_current->state == TASK_READY) {
+            ready_rotate(sched_current->priority);
+        }
+    }
+    sched_reschedule();
+    irq_restore(primask);
+}
+
+/**
+ * @brief Returns the SysTick ticks until the earliest sleeping task is due,
+ *        0 if one is already due, or UINT32_MAX if no task is sleeping.
+ *        Interrupts must be disabled.
+ */
+uint32_t sched_ticks_until_wake(void)
+{
+    if (sleep_list == NULL) {
+        return UINT32_MAX;
+    }
+    int32_t left = (int32_t)(sleep_list->wake_tick - time_ticks());
+    return (left > 0) ? (uint32_t)left : 0;
+}
+
+/**
+ * @brief Blocks the running task until sched_wake() is called for it.
+ *
+ * The caller must have interrupts disabled, so that checking its wait
+ * condition and blocking are atomic. The switch happens when the caller
+ * re-enables interrupts.
+ */
+void sched_block(void)
+{
+    Task *t = sched_current;
+    TRACE(TRACE_EV_BLOCK, t->id, 0);
+    ready_remove(t);
+    t->state = TASK_BLOCKED;
+    t->timed_out = 0;
+    sched_reschedule();
+}
+
+/**
+ * @brief Like sched_block(), but the task is also woken after 'ticks' ticks
+ *        with timed_out set. SCHED_WAIT_FOREVER disables the timeout.
+ *        Interrupts must be disabled.
+ */
+void sched_block_timeout(uint32_t ticks)
+{
+    sched_block();
+    if (ticks != SCHED_WAIT_FOREVER) {
+        sleep_insert(sched_current, time_ticks() + ticks);
+    }
+}
+
+/**
+ * @brief Makes a blocked task ready again. Safe to call from an ISR.
+ */
+void sched_wake(Task *task)
+{
+    if (task == NULL) return;
+
+    uint32_t primask = irq_save();
+    TRACE(TRACE_EV_WAKE, task->id, task->state);
+    if (task->state == TASK_BLOCKED) {
+        if (task->in_sleep_list) {
+            sleep_remove(task);
+        }
+        ready_push(task);
+        sched_reschedule();
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief Creates a task and makes it ready to run.
+ *
+ * The stack is taken from the heap and filled with a pattern so 'ps' can
+ * report how much of it has been used. It starts with an exception frame,
+ * as if the task had been preempted just before its first instruction;
+ * returning from 'entry' lands in task_exit().
+ * @param priority   0 (highest) to SCHED_PRIO_IDLE - 1.
+ * @param stack_size Stack size in bytes, at least SCHED_MIN_STACK.
+ * @return The new task, or NULL if the arguments are invalid or memory is exhausted.
+ */
+Task *task_create(const char *name, TaskEntry entry, void *arg, uint32_t priority, size_t stack_size)
+{
+    if (entry == NULL || priority >= SCHED_PRIORITIES) {
+        return NULL;
+    }
+    if (stack_size < SCHED_MIN_STACK) {
+        stack_size = SCHED_MIN_STACK;
+    }
+    stack_size = (stack_size + 7) & ~7u;
+
+    sched_reap();
+
+    Task *t = pool_alloc(&task_pool);
+    if (t == NULL) {
+        LOG_WARN(SCHED, "No free task slot for '%s'\n", name);
+        return NULL;
+    }
+    uint32_t *stack = malloc(stack_size);
+    if (stack == NULL) {
+        LOG_WARN(SCHED, "No heap for the %u-byte stack of '%s'\n", (uint32_t)stack_size, name);
+        pool_free(&task_pool, t);
+        return NULL;
+    }
+    memset32(stack, SCHED_STACK_FILL, stack_size / 4);
+
+    // Exception frame (8-byte aligned) followed by r4-r11.
+    uint32_t *sp = (uint32_t *)(((uint32_t)stack + stack_size) & ~7u);
+    *--sp = XPSR_THUMB;              // xPSR
+    *--sp = (uint32_t)entry & ~1u;   // PC
+    *--sp = (uint32_t)task_exit;     // LR
+    *--sp = 0;                       // r12
+    *--sp = 0;                       // r3
+    *--sp = 0;                       // r2
+    *--sp = 0;                       // r1
+    *--sp = (uint32_t)arg;           // r0
+    for (int i = 0; i < 8; i++) {
+        *--sp = 0;                   // r11..r4
+    }
+
+    t->sp = sp;
+    t->name = name;
+    t->priority = (uint8_t)priority;
+    t->base_priority = (uint8_t)priority;
+    t->wait_obj = NULL;
+    t->in_sleep_list = 0;
+    t->timed_out = 0;
+    t->stack_base = stack;
+    t->stack_size = stack_size;
+    t->wake_tick = 0;
+    t->switches = 0;
+    t->cpu_cycles = 0;
+
+    uint32_t primask = irq_save();
+    t->id = next_task_id++;
+    t->all_next = task_list;
+    task_list = t;
+    ready_push(t);
+    sched_reschedule();
+    irq_restore(primask);
+    return t;
+}
+
+/**
+ * @brief Ends the running task. Also reached when a task function returns.
+ *        Its stack is freed by a later task_create().
+ */
+void task_exit(void)
+{
+    irq_save();
+    Task *t = sched_current;
+    ready_remove(t);
+    t->state = TASK_DEAD;
+    sched_reschedule();
+    irq_restore(0); // PendSV switches away for good.
+
+    while (1);
+}
+
+/**
+ * @brief Gives the CPU to the next ready task of the same priority, if any.
+ */
+void task_yield(void)
+{
+    uint32_t primask = irq_save();
+    if (sched_started) {
+        ready_rotate(sched_current->priority);
+        sched_reschedule();
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief Changes a task's effective priority, moving it to the new ready
+ *        queue if it is ready. Used for priority inheritance; base_priority
+ *        is left alone. Interrupts must be disabled.
+ */
+void sched_set_priority(Task *task, uint32_t priority)
+{
+    if (task->priority == priority) return;
+
+    if (task->state == TASK_READY) {
+        ready_remove(task);
+        task->priority = (uint8_t)priority;
+        if (task == sched_current) {
+            ready_push_front(task); // Not preempted by its new peers.
+        } else {
+            ready_push(task);
+        }
+    } else {
+        task->priority = (uint8_t)priority;
+    }
+    sched_reschedule();
+}
+
+/**
+ * @brief Suspends the running task for at least 'ticks' SysTick ticks.
+ *
+ * Before sched_start() this just waits with WFI.
+ */
+void task_sleep(uint32_t ticks)
+{
+    if (!sched_started) {
+        uint32_t end = time_ticks() + ticks;
+        while ((int32_t)(time_ticks() - end) < 0) {
+            cpu_wfi();
+        }
+        return;
+    }
+    if (ticks == 0) {
+        task_yield();
+        return;
+    }
+
+    uint32_t primask = irq_save();
+    Task *t = sched_current;
+    ready_remove(t);
+    t->state = TASK_SLEEPING;
+    sleep_insert(t, time_ticks() + ticks);
+
+    sched_reschedule();
+    irq_restore(primask);
+}
+
+/**
+ * @brief Returns the running task (NULL before sched_start()).
+ */
+Task *task_current(void)
+{
+    return sched_current;
+}
+
+/**
+ * @brief Returns the first task of the list of all tasks; follow all_next
+ *        for the rest.
+ */
+Task *sched_task_list(void)
+{
+    return task_list;
+}
+
+/**
+ * @brief Returns how many bytes of a task's stack have ever been written.
+ */
+static uint32_t task_stack_used(const Task *t)
+{
+    uint32_t words = t->stack_size / 4;
+    uint32_t i = 0;
+    while (i < words && t->stack_base[i] == SCHED_STACK_FILL) {
+        i++;
+    }
+    return (words - i) * 4;
+}
+
+/**
+ * @brief Prints every task with its CPU time and switch count ('ps' command).
+ */
+void sched_print_stats(void)
+{
+    char num[12];
+    uint64_t now = time_cycles();
+    uint64_t total = now - sched_start_cycles;
+    uint32_t cycles_per_ms = sysclk_get_hz() / 1000;
+
+    if (!sched_started) {
+        print_str("Scheduler not started.\n");
+        return;
+    }
+    if (total == 0) total = 1;
+
+    print_str("Tasks:\n");
+    for (Task *t = task_list; t != NULL; t = t->all_next) {
+        uint64_t cycles = t->cpu_cycles;
+        if (t == sched_current) {
+            cycles += now - switch_in_cycles;
+        }
+        print_str("  "); itoa(t->id, num); print_str(num);
+        print_str(" "); print_str(t->name);
+        print_str(" | Prio: "); itoa(t->priority, num); print_str(num);
+        if (t->priority != t->base_priority) {
+            print_str(" (base "); itoa(t->base_priority, num); print_str(num); print_str(")");
+        }
+        print_str(" | State: ");
+        print_str(t == sched_current ? "running" : task_state_names[t->state]);
+        print_str(" | CPU: "); itoa((uint32_t)(cycles / cycles_per_ms), num); print_str(num);
+        print_str(" ms ("); itoa((uint32_t)(cycles * 100 / total), num); print_str(num);
+        print_str("%) | Switches: "); itoa(t->switches, num); print_str(num);
+        print_str(" | Stack: "); itoa(task_stack_used(t), num); print_str(num);
+        print_str("/"); itoa(t->stack_size, num); print_str(num);
+        print_str("\n");
+    }
+    print_str("Context switches: "); itoa(sched_switch_count, num); print_str(num); print_str("\n");
+}
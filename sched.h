@@ -0,0 +1,73 @@
+#ifndef __SCHED_H_
+#define __SCHED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Scheduler preemptive berbasis prioritas.
+ * - SCHED_PRIORITIES level prioritas, 0 = tertinggi. Task READY dengan
+ *   prioritas tertinggi selalu yang berjalan.
+ * - Pemilihan task O(1): satu bit per level di ready bitmap + instruksi CLZ.
+ * - Round-robin antar task dengan prioritas sama setiap SCHED_TIMESLICE_TICKS.
+ * - Context switch di PendSV: r4-r11 disimpan di stack task, PSP di Task.sp.
+ *   Task berjalan di Thread mode dengan PSP; handler interrupt tetap di MSP.
+ */
+#define SCHED_PRIORITIES       32
+#define SCHED_PRIO_IDLE        (SCHED_PRIORITIES - 1) // Hanya untuk task idle
+#define SCHED_TIMESLICE_TICKS  10   // 10 ms pada SYSTICK_HZ = 1000
+#define SCHED_MAX_TASKS        8    // Jumlah TCB di pool 'tasks'
+#define SCHED_MIN_STACK        256  // Byte; cukup untuk frame exception + context
+#define SCHED_IDLE_STACK       256
+#define SCHED_WAIT_FOREVER     0xFFFFFFFFu // Tanpa timeout untuk sched_block_timeout()
+
+typedef enum {
+    TASK_READY,     // Di antrian ready (termasuk yang sedang berjalan)
+    TASK_SLEEPING,  // Menunggu tick tertentu (task_sleep)
+    TASK_BLOCKED,   // Menunggu sched_wake() dari driver/ISR, mungkin dengan timeout
+    TASK_DEAD       // Sudah keluar, stack menunggu dibebaskan
+} TaskState;
+
+typedef struct Task {
+    uint32_t *sp;           // PSP tersimpan; HARUS field pertama (dibaca PendSV)
+    const char *name;       // Nama untuk perintah 'ps'
+    uint8_t priority;       // 0 = tertinggi
+    uint8_t state;          // TaskState
+    uint16_t id;
+    uint32_t *stack_base;   // Awal stack (hasil malloc)
+    uint32_t stack_size;    // Ukuran stack dalam byte
+    uint32_t wake_tick;     // Tick bangun saat TASK_SLEEPING atau batas waktu tunggu
+    uint32_t switches;      // Berapa kali task ini mendapat CPU lewat context switch
+    uint64_t cpu_cycles;    // Total siklus CPU yang dipakai task
+    struct Task *next;      // Antrian ready atau antrian tunggu objek sync
+    struct Task *all_next;  // Daftar semua task (untuk 'ps')
+    uint8_t base_priority;  // Prioritas asli; 'priority' bisa naik karena pewarisan (mutex)
+    uint8_t wait_mode;      // Mode tunggu event flags (sync.h)
+    uint8_t in_sleep_list;  // 1 jika ada di daftar sleep (tidur atau tunggu dengan timeout)
+    uint8_t timed_out;      // 1 jika tunggu terakhir berakhir karena timeout
+    struct Task *sleep_next; // Daftar sleep, urut wake_tick
+    void *wait_obj;         // Objek sync yang ditunggu saat TASK_BLOCKED, NULL jika bukan
+    uint32_t wait_value;    // Mask event yang ditunggu, lalu bit yang diterima
+} Task;
+
+typedef void (*TaskEntry)(void *arg);
+
+void sched_init(void);
+void sched_start(void) __attribute__((noreturn));
+int sched_running(void);
+void sched_tick(void);
+uint32_t sched_ticks_until_wake(void);
+void sched_block(void);
+void sched_block_timeout(uint32_t ticks);
+void sched_wake(Task *task);
+void sched_set_priority(Task *task, uint32_t priority);
+void sched_print_stats(void);
+
+Task *task_create(const char *name, TaskEntry entry, void *arg, uint32_t priority, size_t stack_size);
+void task_exit(void) __attribute__((noreturn));
+void task_yield(void);
+void task_sleep(uint32_t ticks);
+Task *task_current(void);
+Task *sched_task_list(void);
+
+#endif // __SCHED_H_
@@ -0,0 +1,237 @@
+#include "shell.h"
+#include <stddef.h>
+
+void print_str(const char *str);
+int strcmp(const char *s1, const char *s2);
+int strlen(const char *s);
+void panic(const char *message);
+
+static const ShellCommand *shell_table;
+static uint32_t shell_count;
+
+/**
+ * @brief Registers the command table and checks that it is sorted by name,
+ *        which the binary search in shell_find() relies on.
+ */
+void shell_init(const ShellCommand *table, uint32_t count)
+{
+    for (uint32_t i = 1; i < count; i++) {
+        if (strcmp(table[i - 1].name, table[i].name) >= 0) {
+            panic("Shell command table not sorted");
+        }
+    }
+    shell_table = table;
+    shell_count = count;
+}
+
+/**
+ * @brief Splits a line into words in place, in a single pass.
+ *
+ * Each word is terminated by overwriting the space after it. The first word
+ * is folded to lower case, since command names are case-insensitive. Once
+ * max - 1 words are split off, the rest of the line becomes the last word.
+ * @param argv Receives up to 'max' pointers into 'line'.
+ * @return The number of words.
+ */
+int shell_tokenize(char *line, char **argv, int max)
+{
+    int argc = 0;
+    char *p = line;
+
+    while (argc < max) {
+        while (*p == ' ') p++;
+        if (*p == '\0') break;
+
+        argv[argc++] = p;
+        if (argc == max) {
+            // Keep the rest intact, minus trailing spaces.
+            char *end = p + strlen(p);
+            while (end > p && end[-1] == ' ') end--;
+            *end = '\0';
+            break;
+        }
+        while (*p != ' ' && *p != '\0') {
+            if (argc == 1 && *p >= 'A' && *p <= 'Z') {
+                *p += 'a' - 'A';
+            }
+            p++;
+        }
+        if (*p == ' ') {
+            *p++ = '\0';
+        }
+    }
+    return argc;
+}
+
+/**
+ * @brief Parses a whole word as an unsigned number.
+ * @param base 10, or 16 with an optional "0x" prefix.
+ * @return 0 on success, -1 if the word is empty, has other characters or
+ *         does not fit in 32 bits.
+ */
+int shell_parse_num(const char *s, uint32_t base, uint32_t *out)
+{
+    uint32_t result = 0;
+
+    if (base == 16 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        s += 2;
+    }
+    if (*s == '\0') {
+        return -1;
+    }
+    for (; *s != '\0'; s++) {
+        uint32_t digit;
+        char c = *s;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (base == 16 && c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (base == 16 && c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return -1;
+        }
+        if (result > (0xFFFFFFFFu - digit) / base) {
+            return -1;
+        }
+        result = result * base + digit;
+    }
+    *out = result;
+    return 0;
+}
+
+/**
+ * @brief Checks tokens against an argument spec and converts the numbers.
+ *
+ * For an 'r' argument the words split off after it are joined again: the
+ * tokenizer replaced exactly one space after each word, so putting it back
+ * restores the original text.
+ * @param tokens Words from shell_tokenize(); tokens[0] is the command name.
+ * @param args   Receives argc entries; args[0] is the command name.
+ * @return The argument count (at most argc), or -1 if the tokens do not fit the spec.
+ */
+int shell_parse_args(const char *spec, int argc, char **tokens, ShellArg *args)
+{
+    int required = 0;
+    int total = strlen(spec);
+    for (int i = 0; i < total; i++) {
+        if (spec[i] >= 'a' && spec[i] <= 'z') required++;
+    }
+
+    args[0].str = tokens[0];
+    args[0].num = 0;
+    for (int i = 1; i < argc; i++) {
+        if (i > total) {
+            return -1;
+        }
+        char type = spec[i - 1] | 0x20; // Lower case
+        args[i].str = tokens[i];
+        args[i].num = 0;
+        if (type == 'd' || type == 'x') {
+            if (shell_parse_num(tokens[i], type == 'd' ? 10 : 16, &args[i].num) != 0) {
+                return -1;
+            }
+        } else if (type == 'r') {
+            for (int j = i; j < argc - 1; j++) {
+                tokens[j][strlen(tokens[j])] = ' ';
+            }
+            argc = i + 1;
+        }
+    }
+    return (argc - 1 < required) ? -1 : argc;
+}
+
+/**
+ * @brief Finds a command by name with a binary search.
+ * @return The command, or NULL if there is none.
+ */
+const ShellCommand *shell_find(const char *name)
+{
+    uint32_t lo = 0;
+    uint32_t hi = shell_count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        int cmp = strcmp(name, shell_table[mid].name);
+        if (cmp == 0) {
+            return &shell_table[mid];
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tokenizes a line, validates its arguments and runs the command.
+ * @return 1 if a command ran, 0 for an empty line, -1 if the command is
+ *         unknown or its arguments are invalid (a message has been printed).
+ *         A handler rejecting its argument values also counts as invalid.
+ */
+int shell_execute(char *line)
+{
+    char *tokens[SHELL_MAX_ARGS];
+    ShellArg args[SHELL_MAX_ARGS];
+
+    int argc = shell_tokenize(line, tokens, SHELL_MAX_ARGS);
+    if (argc == 0) {
+        return 0;
+    }
+    const ShellCommand *cmd = shell_find(tokens[0]);
+    if (cmd == NULL) {
+        print_str("Command not found: "); print_str(tokens[0]); print_str("\n");
+        return -1;
+    }
+    argc = shell_parse_args(cmd->spec, argc, tokens, args);
+    if (argc < 0 || cmd->fn(argc, args) != 0) {
+        shell_print_usage(cmd->name, cmd->args);
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Prints "Usage: <name> <args>".
+ */
+void shell_print_usage(const char *name, const char *args)
+{
+    print_str("Usage: "); print_str(name);
+    if (args[0] != '\0') {
+        print_str(" "); print_str(args);
+    }
+    print_str("\n");
+}
+
+/**
+ * @brief Prints one 'help' line with the description at SHELL_HELP_COL.
+ */
+void shell_print_help_line(const char *name, const char *args, const char *help)
+{
+    static const char pad[] = "                    "; // SHELL_HELP_COL - 1 spaces
+    int col = 2 + strlen(name);
+
+    print_str("  "); print_str(name);
+    if (args[0] != '\0') {
+        print_str(" "); print_str(args);
+        col += 1 + strlen(args);
+    }
+    if (col > SHELL_HELP_COL) {
+        print_str(" ");
+    } else if (col < SHELL_HELP_COL) {
+        print_str(pad + (sizeof(pad) - 1) - (SHELL_HELP_COL - col));
+    }
+    print_str("- "); print_str(help); print_str("\n");
+}
+
+/**
+ * @brief Prints a help line for every command in the table.
+ */
+void shell_print_help(void)
+{
+    for (uint32_t i = 0; i < shell_count; i++) {
+        shell_print_help_line(shell_table[i].name, shell_table[i].args, shell_table[i].help);
+    }
+}
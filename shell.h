@@ -0,0 +1,51 @@
+#ifndef __SHELL_H_
+#define __SHELL_H_
+
+#include <stdint.h>
+
+/*
+ * Dispatch perintah shell berbasis tabel.
+ * - Baris dipecah sekali menjadi argc/argv di tempat (spasi diganti '\0').
+ * - Tabel perintah diurutkan menurut nama saat kompilasi dan dicari dengan
+ *   binary search, jadi menambah perintah tidak memperpanjang rantai strcmp.
+ *   shell_init() memeriksa urutannya.
+ * - Setiap perintah punya spesifikasi argumen; angka sudah divalidasi dan
+ *   diubah sebelum handler dipanggil. Input salah mencetak "Usage: ...".
+ * - 'help' dibuat dari tabel.
+ *
+ * Spesifikasi argumen: satu huruf per argumen, huruf kecil = wajib, huruf
+ * besar = opsional (harus di belakang yang wajib).
+ *   d  angka desimal          x  angka hex (awalan 0x opsional)
+ *   s  satu kata              r  sisa baris apa adanya (hanya di akhir)
+ */
+#define SHELL_MAX_ARGS   8   // Termasuk nama perintah
+#define SHELL_HELP_COL   21  // Kolom tempat "- keterangan" dimulai di 'help'
+
+typedef struct ShellArg {
+    const char *str;         // Token aslinya
+    uint32_t num;            // Nilai untuk argumen 'd' dan 'x', 0 untuk yang lain
+} ShellArg;
+
+// argv[0] adalah nama perintah; argc termasuk argumen opsional yang diberikan.
+// Mengembalikan 0, atau -1 jika nilai argumen tidak masuk akal (usage dicetak).
+typedef int (*ShellHandler)(int argc, const ShellArg *argv);
+
+typedef struct ShellCommand {
+    const char *name;
+    ShellHandler fn;
+    const char *spec;        // Spesifikasi argumen (lihat di atas)
+    const char *args;        // Untuk help dan usage, mis. "<addr> [ms]"
+    const char *help;
+} ShellCommand;
+
+void shell_init(const ShellCommand *table, uint32_t count);
+int shell_tokenize(char *line, char **argv, int max);
+int shell_parse_num(const char *s, uint32_t base, uint32_t *out);
+int shell_parse_args(const char *spec, int argc, char **tokens, ShellArg *args);
+const ShellCommand *shell_find(const char *name);
+int shell_execute(char *line);
+void shell_print_usage(const char *name, const char *args);
+void shell_print_help_line(const char *name, const char *args, const char *help);
+void shell_print_help(void);
+
+#endif // __SHELL_H_
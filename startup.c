@@ -1,22 +1,21 @@
 #include <stdint.h> // Standard C header for fixed-width integer types (e.g., uint32_t, uint16_t).
                     // Crucial for precise bit-width interactions with hardware registers.
 #include "reg.h"    // Custom header defining hardware register addresses, now updated for LM3S6965evb.
+#include "sysclk.h" // sysclk_init(): switches the core to the 50 MHz PLL clock.
+#include "systick.h" // SysTick cycle counter, tick handler and boot phase timestamps.
 
 /*
  * --- IMPORTANT NOTE ---
- * This 'startup.c' has been simplified for the LM3S6965evb target.
- * The complex clock initialization functions (like RCC_CR, RCC_CFGR, FLASH_ACR definitions and the
- * rcc_clock_init() function itself) that were specific to STM32 microcontrollers have been removed.
+ * This 'startup.c' targets the LM3S6965evb. The STM32-specific clock code (RCC_CR, RCC_CFGR,
+ * FLASH_ACR and rcc_clock_init()) that this file was derived from is gone; the LM3S6965 system
+ * clock (SYSCTL RCC + PLL) is configured by sysclk_init() in sysclk.c instead.
  *
- * For the LM3S6965evb target on QEMU, basic clocking for peripherals like UART0 is often implicitly
- * handled by the emulator or is simple enough to be done directly in the peripheral's initialization
- * function (e.g., uart0_init() in hello.c).
- *
- * The primary roles of this simplified startup.c are now:
+ * The primary roles of startup.c are:
  * 1. Copying initialized global data from Flash (ROM) to SRAM (RAM).
  * 2. Zero-filling uninitialized global data in SRAM.
- * 3. Defining the Interrupt Vector Table (which includes the initial Stack Pointer and the Reset Handler).
- * 4. Calling the 'main' function of the OS.
+ * 3. Bringing the system clock up to 50 MHz (sysclk_init()).
+ * 4. Defining the Interrupt Vector Table (which includes the initial Stack Pointer and the Reset Handler).
+ * 5. Calling the 'main' function of the OS.
  */
 
 
@@ -38,6 +37,9 @@ extern uint32_t _sdata;  // Start address for the .data section in RAM (Virtual
                          // This is the actual RAM location where the initialized global variables will reside during runtime.
 extern uint32_t _edata;  // End address for the .data section in RAM.
                          // Used as a boundary for the data copying loop.
+extern uint32_t _siramfunc; // Start address of the .ramfunc code image in Flash (LMA).
+extern uint32_t _sramfunc;  // Start address of the .ramfunc section in RAM (VMA).
+extern uint32_t _eramfunc;  // End address of the .ramfunc section in RAM.
 extern uint32_t _sbss;   // Start address for the .bss section in RAM.
                          // This is where uninitialized global variables will reside.
 extern uint32_t _ebss;   // End address for the .bss section in RAM.
@@ -53,6 +55,11 @@ extern uint32_t _estack; // End address for the stack (typically the highest mem
  */
 void reset_handler(void)
 {
+    /* Start the boot clock */
+    // SysTick counts core cycles from here on, so every boot phase can be timed.
+    // Only registers are touched; .data and .bss are not valid yet.
+    systick_start_free_running();
+
     /* Copy the data segment initializers from flash to SRAM */
     // This section copies initialized global variables from Flash memory (ROM),
     // where they are stored as part of the program binary, to SRAM (RAM).
@@ -66,6 +73,20 @@ void reset_handler(void)
         *data_begin++ = *idata_begin++; // Copy from Flash to RAM, then advance pointers.
     }
 
+    /* Copy the RAM-resident code (.ramfunc) from flash to SRAM */
+    // Functions tagged with RAMFUNC (interrupt handlers, copy loops) are linked to run
+    // from SRAM to avoid Flash wait states, but their code is stored in Flash.
+    // They must not be called before this copy is done.
+    uint32_t *iramfunc_begin = &_siramfunc;
+    uint32_t *ramfunc_begin = &_sramfunc;
+    uint32_t *ramfunc_end = &_eramfunc;
+    while (ramfunc_begin < ramfunc_end)
+    {
+        *ramfunc_begin++ = *iramfunc_begin++;
+    }
+
+    uint32_t data_done = systick_boot_cycles(); // Kept on the stack until .bss is ready.
+
     /* Zero fill the bss segment. */
     // This section fills all bytes in the '.bss' segment with zero.
     // The '.bss' segment contains uninitialized global variables (e.g., `int counter;`).
@@ -77,12 +98,18 @@ void reset_handler(void)
     {
         *bss_begin++ = 0; // Write 0 to each location in .bss, then advance pointer.
     }
+    uint32_t bss_done = systick_boot_cycles();
+
+    // Now that .bss is usable, hand the early timestamps to the boot profile.
+    boot_stamp_at(BOOT_PHASE_DATA, data_done, SYSCLK_PIOSC_HZ);
+    boot_stamp_at(BOOT_PHASE_BSS, bss_done, SYSCLK_PIOSC_HZ);
 
-    // --- Clock system initialization removed for LM3S6965evb simplification ---
-    // The complex clock initialization function (rcc_clock_init) and its related
-    // bit definitions for STM32 have been removed as they are not compatible
-    // with LM3S6965evb. Basic peripheral clocking for UART0 is now handled
-    // within the uart0_init() function in hello.c.
+    /* Clock system initialization */
+    // Switch from the 12 MHz internal oscillator to the 50 MHz PLL clock. This runs
+    // after .data/.bss are set up because sysclk.c records the resulting frequency
+    // in a global, which drivers (e.g. uart0_set_baud()) use to compute divisors.
+    sysclk_init();
+    boot_stamp_at(BOOT_PHASE_CLOCK, systick_boot_cycles(), sysclk_get_hz());
 
     // Call the 'main()' function of your kernel.
     // After all fundamental setup (copy .data, zero .bss) is complete,
@@ -98,16 +125,83 @@ void reset_handler(void)
  * For minimal OSes, they often just contain an infinite loop to halt the CPU
  * if an unexpected error occurs.
  */
+/*
+ * Core exception handlers. They are weak so a driver or fault reporter can
+ * provide its own version without editing this file.
+ */
+__attribute__((weak))
 void nmi_handler(void) // Non-Maskable Interrupt (NMI) handler.
 {                      // This is a high-priority interrupt that cannot be ignored.
     while (1);         // Infinite loop: If an NMI occurs, the CPU will halt here.
 }
 
+__attribute__((weak))
 void hardfault_handler(void) // Hard Fault handler.
 {                            // This is a fatal error detected by the CPU (e.g., illegal memory access).
     while (1);               // Infinite loop: If a Hard Fault occurs, the CPU will halt here.
 }
 
+void default_handler(void) // Catch-all for exceptions and interrupts without a dedicated handler.
+{
+    while (1);             // Infinite loop: An unexpected interrupt halts the CPU here.
+}
+
+/*
+ * Weak handler aliases
+ * Every vector below resolves to default_handler unless another module defines
+ * a (strong) function with the same name, e.g. uart0_isr() in uart.c or
+ * systick_isr() in systick.c. Adding a driver therefore never requires
+ * touching the vector table.
+ */
+#define WEAK_HANDLER __attribute__((weak, alias("default_handler")))
+
+void memmanage_handler(void) WEAK_HANDLER;
+void busfault_handler(void) WEAK_HANDLER;
+void usagefault_handler(void) WEAK_HANDLER;
+void svc_handler(void) WEAK_HANDLER;
+void debugmon_handler(void) WEAK_HANDLER;
+void pendsv_handler(void) WEAK_HANDLER;
+void systick_isr(void) WEAK_HANDLER;
+
+void gpioa_isr(void) WEAK_HANDLER;
+void gpiob_isr(void) WEAK_HANDLER;
+void gpioc_isr(void) WEAK_HANDLER;
+void gpiod_isr(void) WEAK_HANDLER;
+void gpioe_isr(void) WEAK_HANDLER;
+void uart0_isr(void) WEAK_HANDLER;
+void uart1_isr(void) WEAK_HANDLER;
+void ssi0_isr(void) WEAK_HANDLER;
+void i2c0_isr(void) WEAK_HANDLER;
+void pwm_fault_isr(void) WEAK_HANDLER;
+void pwm_gen0_isr(void) WEAK_HANDLER;
+void pwm_gen1_isr(void) WEAK_HANDLER;
+void pwm_gen2_isr(void) WEAK_HANDLER;
+void qei0_isr(void) WEAK_HANDLER;
+void adc0_ss0_isr(void) WEAK_HANDLER;
+void adc0_ss1_isr(void) WEAK_HANDLER;
+void adc0_ss2_isr(void) WEAK_HANDLER;
+void adc0_ss3_isr(void) WEAK_HANDLER;
+void watchdog_isr(void) WEAK_HANDLER;
+void timer0a_isr(void) WEAK_HANDLER;
+void timer0b_isr(void) WEAK_HANDLER;
+void timer1a_isr(void) WEAK_HANDLER;
+void timer1b_isr(void) WEAK_HANDLER;
+void timer2a_isr(void) WEAK_HANDLER;
+void timer2b_isr(void) WEAK_HANDLER;
+void comp0_isr(void) WEAK_HANDLER;
+void comp1_isr(void) WEAK_HANDLER;
+void sysctl_isr(void) WEAK_HANDLER;
+void flash_isr(void) WEAK_HANDLER;
+void gpiof_isr(void) WEAK_HANDLER;
+void gpiog_isr(void) WEAK_HANDLER;
+void uart2_isr(void) WEAK_HANDLER;
+void timer3a_isr(void) WEAK_HANDLER;
+void timer3b_isr(void) WEAK_HANDLER;
+void i2c1_isr(void) WEAK_HANDLER;
+void qei1_isr(void) WEAK_HANDLER;
+void ethernet_isr(void) WEAK_HANDLER;
+void hibernate_isr(void) WEAK_HANDLER;
+
 /*
  * Interrupt Vector Table (ISR Vector Table)
  * This is a crucial table of function addresses for ARM Cortex-M CPUs.
@@ -119,16 +213,61 @@ void hardfault_handler(void) // Hard Fault handler.
  * address (typically 0x00000000) for the CPU to find it upon startup.
  */
 __attribute((section(".isr_vector")))
-uint32_t *isr_vectors[] = {
+uint32_t *isr_vectors[16 + IRQ_COUNT] = {
     (uint32_t *)&_estack,         /* 0x00: Initial Stack Pointer (SP) value. The CPU loads this value into SP upon reset. */
     (uint32_t *)reset_handler,    /* 0x04: Reset Handler. The address of the function called immediately after reset. */
     (uint32_t *)nmi_handler,      /* 0x08: NMI Handler. The address of the function called when an NMI occurs. */
-    (uint32_t *)hardfault_handler /* 0x0C: Hard Fault Handler. The address of the function called when a Hard Fault occurs. */
-    // Typically, there are many other handlers after this (Memory Management, Bus Fault, SVC, SysTick, etc.),
-    // as well as handlers for peripheral interrupts (USART, GPIO, Timers, etc.).
-    // For minimal OSes, only the most crucial ones are defined initially.
+    (uint32_t *)hardfault_handler,/* 0x0C: Hard Fault Handler. The address of the function called when a Hard Fault occurs. */
+    (uint32_t *)memmanage_handler,/* 0x10: Memory Management Fault. */
+    (uint32_t *)busfault_handler, /* 0x14: Bus Fault. */
+    (uint32_t *)usagefault_handler,/* 0x18: Usage Fault. */
+    0, 0, 0, 0,                   /* 0x1C-0x28: Reserved. */
+    (uint32_t *)svc_handler,      /* 0x2C: SVCall. */
+    (uint32_t *)debugmon_handler, /* 0x30: Debug Monitor. */
+    0,                            /* 0x34: Reserved. */
+    (uint32_t *)pendsv_handler,   /* 0x38: PendSV. */
+    (uint32_t *)systick_isr,      /* 0x3C: SysTick. */
+    /* Peripheral interrupts (IRQ n lives at 0x40 + 4*n, numbers in reg.h). */
+    (uint32_t *)gpioa_isr,        /* 0x40: IRQ0  GPIO Port A. */
+    (uint32_t *)gpiob_isr,        /* 0x44: IRQ1  GPIO Port B. */
+    (uint32_t *)gpioc_isr,        /* 0x48: IRQ2  GPIO Port C. */
+    (uint32_t *)gpiod_isr,        /* 0x4C: IRQ3  GPIO Port D. */
+    (uint32_t *)gpioe_isr,        /* 0x50: IRQ4  GPIO Port E. */
+    (uint32_t *)uart0_isr,        /* 0x54: IRQ5  UART0. */
+    (uint32_t *)uart1_isr,        /* 0x58: IRQ6  UART1. */
+    (uint32_t *)ssi0_isr,         /* 0x5C: IRQ7  SSI0. */
+    (uint32_t *)i2c0_isr,         /* 0x60: IRQ8  I2C0. */
+    (uint32_t *)pwm_fault_isr,    /* 0x64: IRQ9  PWM Fault. */
+    (uint32_t *)pwm_gen0_isr,     /* 0x68: IRQ10 PWM Generator 0. */
+    (uint32_t *)pwm_gen1_isr,     /* 0x6C: IRQ11 PWM Generator 1. */
+    (uint32_t *)pwm_gen2_isr,     /* 0x70: IRQ12 PWM Generator 2. */
+    (uint32_t *)qei0_isr,         /* 0x74: IRQ13 Quadrature Encoder 0. */
+    (uint32_t *)adc0_ss0_isr,     /* 0x78: IRQ14 ADC0 Sequence 0. */
+    (uint32_t *)adc0_ss1_isr,     /* 0x7C: IRQ15 ADC0 Sequence 1. */
+    (uint32_t *)adc0_ss2_isr,     /* 0x80: IRQ16 ADC0 Sequence 2. */
+    (uint32_t *)adc0_ss3_isr,     /* 0x84: IRQ17 ADC0 Sequence 3. */
+    (uint32_t *)watchdog_isr,     /* 0x88: IRQ18 Watchdog Timer 0. */
+    (uint32_t *)timer0a_isr,      /* 0x8C: IRQ19 Timer0 A. */
+    (uint32_t *)timer0b_isr,      /* 0x90: IRQ20 Timer0 B. */
+    (uint32_t *)timer1a_isr,      /* 0x94: IRQ21 Timer1 A. */
+    (uint32_t *)timer1b_isr,      /* 0x98: IRQ22 Timer1 B. */
+    (uint32_t *)timer2a_isr,      /* 0x9C: IRQ23 Timer2 A. */
+    (uint32_t *)timer2b_isr,      /* 0xA0: IRQ24 Timer2 B. */
+    (uint32_t *)comp0_isr,        /* 0xA4: IRQ25 Analog Comparator 0. */
+    (uint32_t *)comp1_isr,        /* 0xA8: IRQ26 Analog Comparator 1. */
+    0,                            /* 0xAC: IRQ27 Reserved. */
+    (uint32_t *)sysctl_isr,       /* 0xB0: IRQ28 System Control (PLL, brown-out). */
+    (uint32_t *)flash_isr,        /* 0xB4: IRQ29 Flash Control. */
+    (uint32_t *)gpiof_isr,        /* 0xB8: IRQ30 GPIO Port F. */
+    (uint32_t *)gpiog_isr,        /* 0xBC: IRQ31 GPIO Port G. */
+    0,                            /* 0xC0: IRQ32 Reserved. */
+    (uint32_t *)uart2_isr,        /* 0xC4: IRQ33 UART2. */
+    0,                            /* 0xC8: IRQ34 Reserved. */
+    (uint32_t *)timer3a_isr,      /* 0xCC: IRQ35 Timer3 A. */
+    (uint32_t *)timer3b_isr,      /* 0xD0: IRQ36 Timer3 B. */
+    (uint32_t *)i2c1_isr,         /* 0xD4: IRQ37 I2C1. */
+    (uint32_t *)qei1_isr,         /* 0xD8: IRQ38 Quadrature Encoder 1. */
+    0, 0, 0,                      /* 0xDC-0xE4: IRQ39-41 Reserved. */
+    (uint32_t *)ethernet_isr,     /* 0xE8: IRQ42 Ethernet Controller. */
+    (uint32_t *)hibernate_isr     /* 0xEC: IRQ43 Hibernation Module. */
 };
-
-// --- rcc_clock_init function has been removed from here ---
-// Its functionality is now handled by the simplified UART initialization in hello.c
-// and basic QEMU emulation clocking.
@@ -0,0 +1,579 @@
+#include "cpu.h"
+#include "sched.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "sync.h"
+
+void print_str(const char *str);
+void itoa(int n, char *s);
+void print_hex(uint32_t n);
+void panic(const char *message);
+
+#define MUTEX_WAITERS     1u           // Bit 0 of Mutex.owner
+#define MUTEX_OWNER(v)    ((Task *)((v) & ~MUTEX_WAITERS))
+#define SEM_WAITERS       1u           // Bit 0 of Semaphore.count
+#define SEM_UNIT          2u           // One unit in Semaphore.count
+#define EVENT_WAITERS     0x80000000u  // Bit 31 of EventFlags.bits
+#define SYNC_INHERIT_MAX  8            // Longest chain of mutex owners boosted
+
+static SyncObj *sync_list; // Every initialised object, newest first
+
+static const char *const sync_type_names[] = { "mutex", "sem", "event" };
+
+/**
+ * @brief Adds an object to the list shown by 'locks'.
+ */
+static void sync_register(SyncObj *obj, const char *name, uint8_t type)
+{
+    obj->name = name;
+    obj->type = type;
+    obj->waiters = NULL;
+    obj->contended = 0;
+    obj->max_wait = 0;
+    obj->total_wait = 0;
+
+    uint32_t primask = irq_save();
+    obj->next = sync_list;
+    sync_list = obj;
+    irq_restore(primask);
+}
+
+/**
+ * @brief Inserts a task into a wait queue behind every task of equal or
+ *        higher priority. Interrupts must be disabled.
+ */
+static void wait_insert(Task **head, Task *t)
+{
+    while (*head != NULL && (*head)->priority <= t->priority) {
+        head = &(*head)->next;
+    }
+    t->next = *head;
+    *head = t;
+}
+
+/**
+ * @brief Unlinks a task from a wait queue. Interrupts must be disabled.
+ */
+static void wait_remove(Task **head, Task *t)
+{
+    while (*head != NULL && *head != t) {
+        head = &(*head)->next;
+    }
+    if (*head != NULL) {
+        *head = t->next;
+        t->next = NULL;
+    }
+}
+
+/**
+ * @brief Blocks the running task on an object's wait queue for at most
+ *        'ticks' ticks (SCHED_WAIT_FOREVER for no limit).
+ *
+ * Interrupts must be disabled; the task switch happens when the caller
+ * restores them. After a timeout the task's timed_out flag is set.
+ */
+static void sync_block(SyncObj *obj, uint32_t ticks)
+{
+    Task *self = task_current();
+    sched_block_timeout(ticks);
+    self->wait_obj = obj;
+    wait_insert(&obj->waiters, self);
+    obj->contended++;
+}
+
+/**
+ * @brief Hands the CPU back to a waiter: unlinks the highest-priority one
+ *        and makes it ready. Interrupts must be disabled.
+ */
+static void sync_wake(SyncObj *obj, Task *t)
+{
+    wait_remove(&obj->waiters, t);
+    t->wait_obj = NULL;
+    sched_wake(t);
+}
+
+/**
+ * @brief Takes a task whose timed wait expired off its object's wait queue.
+ *        Called by the scheduler tick with interrupts disabled.
+ *
+ * The object's waiter bit may stay set with an empty queue; the next slow
+ * path sees no waiter and clears it.
+ */
+void sync_cancel_wait(Task *t)
+{
+    SyncObj *obj = t->wait_obj;
+    if (obj != NULL) {
+        wait_remove(&obj->waiters, t);
+        t->wait_obj = NULL;
+    }
+}
+
+/**
+ * @brief Adds one wait, measured from 'start', to an object's statistics.
+ */
+static void sync_account_wait(SyncObj *obj, uint64_t start)
+{
+    uint32_t cycles = (uint32_t)(time_cycles() - start);
+    uint32_t primask = irq_save();
+    obj->total_wait += cycles;
+    if (cycles > obj->max_wait) {
+        obj->max_wait = cycles;
+    }
+    irq_restore(primask);
+}
+
+// --- Mutex ---
+
+/**
+ * @brief Initialises an unlocked mutex.
+ */
+void mutex_init(Mutex *m, const char *name)
+{
+    m->owner = 0;
+    m->locks = 0;
+    sync_register(&m->obj, name, SYNC_MUTEX);
+}
+
+/**
+ * @brief Raises the owner of a mutex (and the owners it is waiting for in
+ *        turn) to at least 'priority'. Interrupts must be disabled.
+ */
+static void mutex_inherit(Task *owner, uint32_t priority)
+{
+    for (int depth = 0; owner != NULL && depth < SYNC_INHERIT_MAX; depth++) {
+        if (owner->priority <= priority) {
+            return;
+        }
+        sched_set_priority(owner, priority);
+
+        SyncObj *obj = owner->wait_obj;
+        if (owner->state != TASK_BLOCKED || obj == NULL || obj->type != SYNC_MUTEX) {
+            return;
+        }
+        // Keep the wait queue ordered, then boost the next owner in the chain.
+        wait_remove(&obj->waiters, owner);
+        wait_insert(&obj->waiters, owner);
+        owner = MUTEX_OWNER(((Mutex *)obj)->owner);
+    }
+}
+
+/**
+ * @brief Drops a task back to its base priority, or to the highest priority
+ *        still waiting on a mutex it owns. Interrupts must be disabled.
+ */
+static void mutex_restore_priority(Task *self)
+{
+    uint32_t priority = self->base_priority;
+
+    for (SyncObj *obj = sync_list; obj != NULL; obj = obj->next) {
+        if (obj->type == SYNC_MUTEX && obj->waiters != NULL &&
+            MUTEX_OWNER(((Mutex *)obj)->owner) == self &&
+            obj->waiters->priority < priority) {
+            priority = obj->waiters->priority;
+        }
+    }
+    sched_set_priority(self, priority);
+}
+
+/**
+ * @brief Takes the mutex if it is free, without blocking.
+ * @return 1 if the caller now owns it, 0 otherwise.
+ */
+int mutex_trylock(Mutex *m)
+{
+    uint32_t self = (uint32_t)task_current();
+
+    do {
+        if (cpu_ldrex(&m->owner) != 0) {
+            cpu_clrex();
+            return 0;
+        }
+    } while (cpu_strex(self, &m->owner) != 0);
+    cpu_dmb(); // Critical section accesses stay after the acquire.
+    m->locks++;
+    return 1;
+}
+
+/**
+ * @brief Contended path of mutex_lock(): queues the caller, boosts the owner
+ *        and blocks until mutex_unlock() hands the mutex over.
+ */
+static void mutex_lock_slow(Mutex *m)
+{
+    Task *self = task_current();
+    uint64_t start = time_cycles();
+
+    uint32_t primask = irq_save();
+    uint32_t owner = m->owner;
+    if (owner == 0) {
+        m->owner = (uint32_t)self; // Released in the meantime.
+        irq_restore(primask);
+        m->locks++;
+        return;
+    }
+    if (MUTEX_OWNER(owner) == self) {
+        panic("mutex_lock: mutex already owned by the caller");
+    }
+    m->owner = owner | MUTEX_WAITERS;
+    sync_block(&m->obj, SCHED_WAIT_FOREVER);
+    mutex_inherit(MUTEX_OWNER(owner), self->priority);
+    irq_restore(primask); // Runs again as the owner.
+
+    m->locks++;
+    sync_account_wait(&m->obj, start);
+}
+
+/**
+ * @brief Locks a mutex, blocking while another task owns it.
+ *
+ * Uncontended this is a single LDREX/STREX. Not recursive, and not for ISRs.
+ */
+void mutex_lock(Mutex *m)
+{
+    if (!sched_running()) return;
+    if (!mutex_trylock(m)) {
+        mutex_lock_slow(m);
+    }
+}
+
+/**
+ * @brief Unlocks a mutex owned by the caller.
+ *
+ * Without waiters this is a single LDREX/STREX. Otherwise ownership passes
+ * directly to the highest-priority waiter and the caller gives up any
+ * priority it inherited through this mutex.
+ */
+void mutex_unlock(Mutex *m)
+{
+    if (!sched_running()) return;
+
+    uint32_t self = (uint32_t)task_current();
+    cpu_dmb(); // Critical section accesses complete before the release.
+    do {
+        if (cpu_ldrex(&m->owner) != self) {
+            cpu_clrex();
+            break;
+        }
+        if (cpu_strex(0, &m->owner) == 0) {
+            return;
+        }
+    } while (1);
+
+    uint32_t primask = irq_save();
+    if (MUTEX_OWNER(m->owner) != (Task *)self) {
+        panic("mutex_unlock: caller does not own the mutex");
+    }
+    Task *next = m->obj.waiters;
+    if (next != NULL) {
+        sync_wake(&m->obj, next);
+        m->owner = (uint32_t)next | (m->obj.waiters != NULL ? MUTEX_WAITERS : 0);
+    } else {
+        m->owner = 0;
+    }
+    mutex_restore_priority((Task *)self);
+    irq_restore(primask);
+}
+
+// --- Counting semaphore ---
+
+/**
+ * @brief Initialises a semaphore with 'count' units available.
+ */
+void sem_init(Semaphore *s, const char *name, uint32_t count)
+{
+    s->count = count * SEM_UNIT;
+    sync_register(&s->obj, name, SYNC_SEMAPHORE);
+}
+
+/**
+ * @brief Takes one unit if available, without blocking. Safe from an ISR.
+ * @return 1 on success, 0 if the count is zero.
+ */
+int sem_trytake(Semaphore *s)
+{
+    uint32_t v;
+    do {
+        v = cpu_ldrex(&s->count);
+        if (v < SEM_UNIT) {
+            cpu_clrex();
+            return 0;
+        }
+    } while (cpu_strex(v - SEM_UNIT, &s->count) != 0);
+    cpu_dmb();
+    return 1;
+}
+
+/**
+ * @brief Takes one unit, blocking while the count is zero.
+ *
+ * A waiter is handed its unit directly by sem_give(), so a later sem_trytake()
+ * cannot steal it. Before sched_start() this waits with WFI.
+ */
+void sem_take(Semaphore *s)
+{
+    sem_take_timeout(s, SCHED_WAIT_FOREVER);
+}
+
+/**
+ * @brief Takes one unit, blocking for at most 'ticks' ticks.
+ *
+ * With ticks == 0 this is sem_trytake(). Before sched_start() the timeout is
+ * ignored and this waits with WFI.
+ * @return 0 on success, -1 on timeout.
+ */
+int sem_take_timeout(Semaphore *s, uint32_t ticks)
+{
+    if (sem_trytake(s)) return 0;
+    if (ticks == 0) return -1;
+    if (!sched_running()) {
+        while (!sem_trytake(s)) {
+            cpu_wfi();
+        }
+        return 0;
+    }
+
+    Task *self = task_current();
+    uint64_t start = time_cycles();
+    uint32_t primask = irq_save();
+    if (s->count >= SEM_UNIT) {
+        s->count -= SEM_UNIT;
+        irq_restore(primask);
+        return 0;
+    }
+    s->count |= SEM_WAITERS;
+    sync_block(&s->obj, ticks);
+    irq_restore(primask);
+
+    sync_account_wait(&s->obj, start);
+    return self->timed_out ? -1 : 0;
+}
+
+/**
+ * @brief Returns one unit, waking the highest-priority waiter if any.
+ *        Safe from an ISR.
+ */
+void sem_give(Semaphore *s)
+{
+    uint32_t v;
+    cpu_dmb();
+    do {
+        v = cpu_ldrex(&s->count);
+        if (v & SEM_WAITERS) {
+            cpu_clrex();
+            break;
+        }
+        if (cpu_strex(v + SEM_UNIT, &s->count) == 0) {
+            return;
+        }
+    } while (1);
+
+    uint32_t primask = irq_save();
+    Task *next = s->obj.waiters;
+    if (next != NULL) {
+        sync_wake(&s->obj, next);
+        if (s->obj.waiters == NULL) {
+            s->count &= ~SEM_WAITERS;
+        }
+    } else {
+        s->count = (s->count & ~SEM_WAITERS) + SEM_UNIT;
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief Returns the number of available units.
+ */
+uint32_t sem_count(const Semaphore *s)
+{
+    return s->count / SEM_UNIT;
+}
+
+// --- Event flags ---
+
+/**
+ * @brief Initialises an event group with every bit cleared.
+ */
+void event_init(EventFlags *e, const char *name)
+{
+    e->bits = 0;
+    sync_register(&e->obj, name, SYNC_EVENT);
+}
+
+/**
+ * @brief Returns 1 if 'bits' satisfy a wait for 'mask' in 'mode'.
+ */
+static int event_match(uint32_t bits, uint32_t mask, uint32_t mode)
+{
+    if (mode & EVENT_WAIT_ALL) {
+        return (bits & mask) == mask;
+    }
+    return (bits & mask) != 0;
+}
+
+/**
+ * @brief Checks the wait condition without blocking. Safe from an ISR.
+ * @return The bits of 'mask' that were set, or 0 if the condition is not met.
+ */
+uint32_t event_trywait(EventFlags *e, uint32_t mask, uint32_t mode)
+{
+    uint32_t v;
+    mask &= EVENT_BITS;
+    do {
+        v = cpu_ldrex(&e->bits);
+        if (mask == 0 || !event_match(v, mask, mode)) {
+            cpu_clrex();
+            return 0;
+        }
+        if (!(mode & EVENT_CLEAR)) {
+            cpu_clrex();
+            return v & mask;
+        }
+    } while (cpu_strex(v & ~mask, &e->bits) != 0);
+    return v & mask;
+}
+
+/**
+ * @brief Waits until any (EVENT_WAIT_ANY) or all (EVENT_WAIT_ALL) bits of
+ *        'mask' are set, optionally clearing them (EVENT_CLEAR).
+ * @return The bits of 'mask' that were set when the wait ended.
+ */
+uint32_t event_wait(EventFlags *e, uint32_t mask, uint32_t mode)
+{
+    mask &= EVENT_BITS;
+    if (mask == 0) return 0;
+
+    uint32_t got = event_trywait(e, mask, mode);
+    if (got != 0) return got;
+    if (!sched_running()) {
+        while ((got = event_trywait(e, mask, mode)) == 0) {
+            cpu_wfi();
+        }
+        return got;
+    }
+
+    Task *self = task_current();
+    uint64_t start = time_cycles();
+    uint32_t primask = irq_save();
+    uint32_t bits = e->bits;
+    if (event_match(bits, mask, mode)) {
+        if (mode & EVENT_CLEAR) {
+            e->bits = bits & ~mask;
+        }
+        irq_restore(primask);
+        return bits & mask;
+    }
+    e->bits = bits | EVENT_WAITERS;
+    self->wait_value = mask;
+    self->wait_mode = (uint8_t)mode;
+    sync_block(&e->obj, SCHED_WAIT_FOREVER);
+    irq_restore(primask);
+
+    sync_account_wait(&e->obj, start);
+    return self->wait_value; // Filled in by event_set().
+}
+
+/**
+ * @brief Sets bits and wakes every waiter whose condition is now met.
+ *        Safe from an ISR.
+ */
+void event_set(EventFlags *e, uint32_t mask)
+{
+    uint32_t v;
+    mask &= EVENT_BITS;
+    do {
+        v = cpu_ldrex(&e->bits);
+        if (v & EVENT_WAITERS) {
+            cpu_clrex();
+            break;
+        }
+        if (cpu_strex(v | mask, &e->bits) == 0) {
+            return;
+        }
+    } while (1);
+
+    uint32_t primask = irq_save();
+    uint32_t bits = e->bits | mask;
+    Task *t = e->obj.waiters;
+    while (t != NULL) {
+        Task *next = t->next;
+        if (event_match(bits, t->wait_value, t->wait_mode)) {
+            uint32_t wanted = t->wait_value;
+            t->wait_value = bits & wanted;
+            if (t->wait_mode & EVENT_CLEAR) {
+                bits &= ~wanted;
+            }
+            sync_wake(&e->obj, t);
+        }
+        t = next;
+    }
+    if (e->obj.waiters == NULL) {
+        bits &= ~EVENT_WAITERS;
+    }
+    e->bits = bits;
+    irq_restore(primask);
+}
+
+/**
+ * @brief Clears bits. Never wakes anyone. Safe from an ISR.
+ */
+void event_clear(EventFlags *e, uint32_t mask)
+{
+    uint32_t v;
+    mask &= EVENT_BITS;
+    do {
+        v = cpu_ldrex(&e->bits);
+    } while (cpu_strex(v & ~mask, &e->bits) != 0);
+}
+
+/**
+ * @brief Returns the current event bits.
+ */
+uint32_t event_get(const EventFlags *e)
+{
+    return e->bits & EVENT_BITS;
+}
+
+/**
+ * @brief Lists every mutex, semaphore and event group with its contention
+ *        counters ('locks' command).
+ */
+void sync_print_stats(void)
+{
+    char num[12];
+    uint32_t cycles_per_us = sysclk_get_hz() / 1000000;
+
+    if (sync_list == NULL) {
+        print_str("No locks.\n");
+        return;
+    }
+    print_str("Locks:\n");
+    for (SyncObj *obj = sync_list; obj != NULL; obj = obj->next) {
+        print_str("  "); print_str(obj->name);
+        print_str(" ("); print_str(sync_type_names[obj->type]); print_str(")");
+
+        if (obj->type == SYNC_MUTEX) {
+            Mutex *m = (Mutex *)obj;
+            Task *owner = MUTEX_OWNER(m->owner);
+            print_str(" | Locks: "); itoa(m->locks, num); print_str(num);
+            print_str(" | Owner: "); print_str(owner != NULL ? owner->name : "-");
+        } else if (obj->type == SYNC_SEMAPHORE) {
+            print_str(" | Count: "); itoa(sem_count((Semaphore *)obj), num); print_str(num);
+        } else {
+            print_str(" | Bits: "); print_hex(event_get((EventFlags *)obj));
+        }
+
+        uint32_t waiting = 0;
+        for (Task *t = obj->waiters; t != NULL; t = t->next) {
+            waiting++;
+        }
+        print_str(" | Contended: "); itoa(obj->contended, num); print_str(num);
+        print_str(" | Waiting: "); itoa(waiting, num); print_str(num);
+        if (obj->contended != 0) {
+            print_str(" | Wait avg/max: ");
+            itoa((uint32_t)(obj->total_wait / obj->contended / cycles_per_us), num); print_str(num);
+            print_str("/"); itoa(obj->max_wait / cycles_per_us, num); print_str(num);
+            print_str(" us");
+        }
+        print_str("\n");
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef __SYNC_H_
+#define __SYNC_H_
+
+#include <stdint.h>
+#include "sched.h"
+
+/*
+ * Primitif sinkronisasi antar task: mutex, semaphore counting, event flags.
+ * - Jalur tanpa rebutan hanya satu urutan LDREX/STREX pada satu word, tanpa
+ *   mematikan interrupt dan tanpa masuk ke scheduler.
+ * - Hanya saat harus menunggu (atau ada yang menunggu) jalur lambat dipakai:
+ *   interrupt dimatikan sebentar, task masuk antrian tunggu objek (urut
+ *   prioritas, FIFO untuk prioritas sama) lalu diblokir.
+ * - Mutex memakai pewarisan prioritas: pemilik dinaikkan ke prioritas penunggu
+ *   tertinggi (berantai jika pemilik sendiri menunggu mutex lain) dan turun
+ *   lagi saat melepas.
+ * - Setiap objek terdaftar dan punya penghitung rebutan; lihat perintah 'locks'.
+ * - sem_take_timeout() menyerah setelah sejumlah tick (lewat daftar sleep
+ *   scheduler).
+ * - sem_give() dan event_set() aman dipanggil dari ISR. Sebelum sched_start()
+ *   mutex tidak berbuat apa-apa (hanya ada satu konteks).
+ */
+enum {
+    SYNC_MUTEX,
+    SYNC_SEMAPHORE,
+    SYNC_EVENT
+};
+
+// Mode event_wait()
+#define EVENT_WAIT_ANY  0x00 // Bangun jika salah satu bit di mask diset
+#define EVENT_WAIT_ALL  0x01 // Bangun jika semua bit di mask diset
+#define EVENT_CLEAR     0x02 // Hapus bit yang ditunggu saat bangun
+#define EVENT_BITS      0x7FFFFFFFu // Bit 31 dipakai internal (ada penunggu)
+
+typedef struct SyncObj {
+    const char *name;        // Nama untuk perintah 'locks'
+    uint8_t type;            // SYNC_MUTEX, SYNC_SEMAPHORE, SYNC_EVENT
+    Task *waiters;           // Antrian tunggu, prioritas tertinggi di depan
+    uint32_t contended;      // Berapa kali pemanggil harus menunggu
+    uint32_t max_wait;       // Waktu tunggu terlama (siklus)
+    uint64_t total_wait;     // Total waktu tunggu (siklus)
+    struct SyncObj *next;    // Daftar semua objek sync
+} SyncObj;
+
+typedef struct Mutex {
+    SyncObj obj;
+    volatile uint32_t owner; // Task* pemilik | bit 0 = ada penunggu; 0 = bebas
+    uint32_t locks;          // Jumlah lock berhasil (ditulis oleh pemilik)
+} Mutex;
+
+typedef struct Semaphore {
+    SyncObj obj;
+    volatile uint32_t count; // (hitungan << 1) | bit 0 = ada penunggu
+} Semaphore;
+
+typedef struct EventFlags {
+    SyncObj obj;
+    volatile uint32_t bits;  // Bit event (EVENT_BITS) | bit 31 = ada penunggu
+} EventFlags;
+
+void mutex_init(Mutex *m, const char *name);
+void mutex_lock(Mutex *m);
+int mutex_trylock(Mutex *m);
+void mutex_unlock(Mutex *m);
+
+void sem_init(Semaphore *s, const char *name, uint32_t count);
+void sem_take(Semaphore *s);
+int sem_take_timeout(Semaphore *s, uint32_t ticks);
+int sem_trytake(Semaphore *s);
+void sem_give(Semaphore *s);
+uint32_t sem_count(const Semaphore *s);
+
+void event_init(EventFlags *e, const char *name);
+uint32_t event_wait(EventFlags *e, uint32_t mask, uint32_t mode);
+uint32_t event_trywait(EventFlags *e, uint32_t mask, uint32_t mode);
+void event_set(EventFlags *e, uint32_t mask);
+void event_clear(EventFlags *e, uint32_t mask);
+uint32_t event_get(const EventFlags *e);
+
+void sync_cancel_wait(Task *t);
+void sync_print_stats(void);
+
+#endif // __SYNC_H_
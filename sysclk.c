@@ -0,0 +1,89 @@
+#include "reg.h"
+#include "sysclk.h"
+
+// Number of RIS polls before giving up on the PLL lock.
+#define SYSCLK_PLL_LOCK_TIMEOUT 100000
+
+// Current core clock. Starts at the reset default (internal oscillator) and is
+// updated by sysclk_init(). Lives in .data so it is valid before main().
+static uint32_t sysclk_hz = SYSCLK_PIOSC_HZ;
+static int sysclk_locked;
+
+/**
+ * @brief Brings the core clock up to 50 MHz from the 8 MHz crystal via the PLL.
+ *
+ * Follows the datasheet sequence: bypass the PLL and divider, clear the stale
+ * lock flag, select the crystal and power up the PLL, program SYSDIV, wait
+ * for lock, then switch the system clock over to the PLL. If the PLL does not
+ * lock, the core keeps running straight from the crystal.
+ */
+void sysclk_init(void)
+{
+    // RCC2 would override RCC; make sure the legacy register is in control.
+    *(SYSCTL_RCC2) &= ~SYSCTL_RCC2_USERCC2;
+
+    // 1. Run from the raw oscillator while the PLL is reconfigured.
+    uint32_t rcc = *(SYSCTL_RCC);
+    rcc |= SYSCTL_RCC_BYPASS;
+    rcc &= ~SYSCTL_RCC_USESYSDIV;
+    *(SYSCTL_RCC) = rcc;
+
+    // The lock flag may still be set from the boot ROM or an earlier init;
+    // clear it before the PLL is (re)started so step 4 sees this lock.
+    *(SYSCTL_MISC) = SYSCTL_MISC_PLLLMIS;
+
+    // 2. Main oscillator with the 8 MHz crystal, PLL powered up.
+    rcc &= ~(SYSCTL_RCC_MOSCDIS | SYSCTL_RCC_OSCSRC_MASK | SYSCTL_RCC_XTAL_MASK | SYSCTL_RCC_PWRDN);
+    rcc |= SYSCTL_RCC_OSCSRC_MAIN | SYSCTL_RCC_XTAL_8MHZ;
+    *(SYSCTL_RCC) = rcc;
+    sysclk_hz = SYSCLK_XTAL_HZ;
+
+    // 3. 200 MHz PLL output / (SYSDIV + 1) = 50 MHz.
+    uint32_t sysdiv = SYSCLK_PLL_HZ / SYSCLK_TARGET_HZ - 1;
+    rcc &= ~SYSCTL_RCC_SYSDIV_MASK;
+    rcc |= (sysdiv << SYSCTL_RCC_SYSDIV_SHIFT);
+    *(SYSCTL_RCC) = rcc;
+
+    // 4. Wait for the PLL to lock.
+    for (int i = 0; i < SYSCLK_PLL_LOCK_TIMEOUT; i++) {
+        if (*(SYSCTL_RIS) & SYSCTL_RIS_PLLLRIS) {
+            sysclk_locked = 1;
+            break;
+        }
+    }
+    if (!sysclk_locked) {
+        return;
+    }
+
+    // 5. Enable the divider and switch the system clock to the PLL.
+    rcc |= SYSCTL_RCC_USESYSDIV;
+    rcc &= ~SYSCTL_RCC_BYPASS;
+    *(SYSCTL_RCC) = rcc;
+    sysclk_hz = SYSCLK_PLL_HZ / (sysdiv + 1);
+}
+
+/**
+ * @brief Returns the current core clock frequency in Hz.
+ */
+uint32_t sysclk_get_hz(void)
+{
+    return sysclk_hz;
+}
+
+/**
+ * @brief Returns 1 if the core is running from the locked PLL.
+ */
+int sysclk_pll_locked(void)
+{
+    return sysclk_locked;
+}
+
+/**
+ * @brief Converts a rate into core clock cycles per period, rounded to nearest.
+ *
+ * Used for timer reload values, e.g. sysclk_cycles_per(1000) for a 1 ms tick.
+ */
+uint32_t sysclk_cycles_per(uint32_t rate_hz)
+{
+    return (sysclk_hz + rate_hz / 2) / rate_hz;
+}
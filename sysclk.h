@@ -0,0 +1,21 @@
+#ifndef __SYSCLK_H_
+#define __SYSCLK_H_
+
+#include <stdint.h>
+
+/*
+ * Konfigurasi clock sistem LM3S6965 (SYSCTL RCC/PLL).
+ * Semua driver menghitung pembagi (baud rate, reload timer) dari
+ * sysclk_get_hz() saat runtime, bukan dari konstanta clock yang di-hardcode.
+ */
+#define SYSCLK_XTAL_HZ     8000000   // Kristal utama di board LM3S6965evb
+#define SYSCLK_PIOSC_HZ    12000000  // Osilator internal, sumber clock setelah reset
+#define SYSCLK_PLL_HZ      200000000 // Keluaran PLL sebelum dibagi SYSDIV
+#define SYSCLK_TARGET_HZ   50000000  // Frekuensi maksimum LM3S6965
+
+void sysclk_init(void);
+uint32_t sysclk_get_hz(void);
+int sysclk_pll_locked(void);
+uint32_t sysclk_cycles_per(uint32_t rate_hz);
+
+#endif // __SYSCLK_H_
@@ -0,0 +1,268 @@
+#include "reg.h"
+#include "cpu.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "sched.h"
+
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+static volatile uint32_t systick_ticks; // Ticks since systick_init()
+static uint32_t systick_period;         // Core cycles per tick, 0 while free-running
+static uint64_t systick_base;           // Cycles since reset at systick_init()
+
+// Tickless sleep in progress (see systick_suppress()).
+static uint32_t suppress_load;  // Cycles programmed until the wake-up tick
+static uint32_t suppress_first; // Cycles until the first suppressed tick boundary
+static uint32_t suppress_ticks; // Tick boundaries covered by suppress_load
+
+// End-of-phase timestamps (cycles since reset) and the core clock in effect.
+static uint32_t boot_cycles[BOOT_PHASE_COUNT];
+static uint32_t boot_hz[BOOT_PHASE_COUNT];
+
+static const char *const boot_phase_names[BOOT_PHASE_COUNT] = {
+    ".data copy",
+    ".bss zero",
+    "clock init",
+    "uart0_init",
+    "malloc_init",
+    "first prompt",
+};
+
+/**
+ * @brief Starts SysTick as a free-running 24-bit down-counter on the core clock.
+ *
+ * Called first thing in reset_handler, before .data/.bss exist, so it only
+ * touches registers. Boot phases up to the tick setup must finish within
+ * 2^24 cycles (about 1.4 s at 12 MHz).
+ */
+void systick_start_free_running(void)
+{
+    *(SYST_CSR) = 0;
+    *(SYST_RVR) = SYST_RVR_MAX;
+    *(SYST_CVR) = 0;
+    *(SYST_CSR) = SYST_CSR_CLKSOURCE | SYST_CSR_ENABLE;
+}
+
+/**
+ * @brief Cycles elapsed since systick_start_free_running() (free-running mode only).
+ */
+uint32_t systick_boot_cycles(void)
+{
+    return SYST_RVR_MAX - *(SYST_CVR);
+}
+
+/**
+ * @brief Switches SysTick to a periodic SYSTICK_HZ interrupt.
+ *
+ * The cycles counted so far are carried over, so time_cycles() stays
+ * monotonic across the switch.
+ */
+void systick_init(void)
+{
+    uint32_t primask = irq_save();
+    systick_base = systick_boot_cycles();
+    systick_ticks = 0;
+    systick_period = sysclk_cycles_per(SYSTICK_HZ);
+
+    *(SYST_CSR) = 0;
+    *(SYST_RVR) = systick_period - 1;
+    *(SYST_CVR) = 0;
+    *(SYST_CSR) = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+    irq_restore(primask);
+}
+
+/**
+ * @brief SysTick exception handler: advances the tick count and drives the
+ *        scheduler (sleep timeouts, time slices).
+ */
+RAMFUNC void systick_isr(void)
+{
+    systick_ticks++;
+    sched_tick();
+}
+
+/**
+ * @brief Replaces the next 'ticks' periodic interrupts with a single one.
+ *
+ * Reprograms the reload so the counter only expires on the 'ticks'-th tick
+ * boundary from now. Must be called with interrupts disabled and followed by
+ * systick_resume() once the core wakes up, whatever woke it.
+ * @return The number of ticks actually covered (capped by the 24-bit
+ *         counter), or 0 if a tick is already pending and nothing changed.
+ */
+uint32_t systick_suppress(uint32_t ticks)
+{
+    if (systick_period == 0 || ticks < 2) {
+        return 0;
+    }
+    uint32_t max_ticks = SYST_RVR_MAX / systick_period;
+    if (ticks > max_ticks) {
+        ticks = max_ticks;
+    }
+
+    *(SYST_CSR) = SYST_CSR_CLKSOURCE; // Stop the counter while it is reprogrammed.
+    uint32_t cvr = *(SYST_CVR);
+    if ((*(SCB_ICSR) & SCB_ICSR_PENDSTSET) || cvr == 0) {
+        *(SYST_CSR) = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+        return 0;
+    }
+
+    suppress_first = cvr;
+    suppress_ticks = ticks;
+    suppress_load = cvr + (ticks - 1) * systick_period;
+    *(SYST_RVR) = suppress_load - 1;
+    *(SYST_CVR) = 0;
+    *(SYST_CSR) = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+    return ticks;
+}
+
+/**
+ * @brief Restores the periodic tick after systick_suppress() and accounts
+ *        for the tick boundaries that passed without an interrupt.
+ *
+ * If the wake-up tick was reached its interrupt is still pending and counts
+ * itself; if another interrupt woke the core early, only the boundaries
+ * already passed are added. The next tick keeps the original phase.
+ * Must be called with interrupts disabled.
+ * @param suppressed Receives the number of ticks that produced no interrupt.
+ * @return Core cycles elapsed since systick_suppress().
+ */
+uint32_t systick_resume(uint32_t *suppressed)
+{
+    uint32_t period = systick_period;
+    uint32_t elapsed, next, ticks;
+
+    *(SYST_CSR) = SYST_CSR_CLKSOURCE;
+    uint32_t cvr = *(SYST_CVR);
+
+    if (*(SCB_ICSR) & SCB_ICSR_PENDSTSET) {
+        // Counter expired and reloaded: 'since' cycles into the next sleep period.
+        uint32_t since = (suppress_load - 1) - cvr;
+        elapsed = suppress_load + since;
+        ticks = suppress_ticks - 1 + since / period;
+        next = period - since % period;
+    } else {
+        elapsed = (suppress_load - 1) - cvr;
+        ticks = (elapsed >= suppress_first) ? 1 + (elapsed - suppress_first) / period : 0;
+        next = suppress_first + ticks * period - elapsed;
+    }
+    systick_ticks += ticks;
+    if (next < 2) {
+        next = 2; // A reload value of 0 would stop the counter.
+    }
+
+    // Run the remainder of the current tick, then fall back to full periods.
+    *(SYST_RVR) = next - 1;
+    *(SYST_CVR) = 0;
+    *(SYST_CSR) = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+    *(SYST_RVR) = period - 1;
+
+    if (suppressed != NULL) *suppressed = ticks;
+    return elapsed;
+}
+
+/**
+ * @brief Returns core clock cycles elapsed since reset.
+ *
+ * Combines the tick count with the current counter value. If the counter
+ * wrapped but the SysTick exception has not run yet (interrupts masked), the
+ * pending bit accounts for the missing tick.
+ */
+uint64_t time_cycles(void)
+{
+    if (systick_period == 0) {
+        return systick_boot_cycles();
+    }
+
+    uint32_t primask = irq_save();
+    uint32_t ticks = systick_ticks;
+    uint32_t cvr = *(SYST_CVR);
+    if (*(SCB_ICSR) & SCB_ICSR_PENDSTSET) {
+        cvr = *(SYST_CVR);
+        ticks++;
+    }
+    irq_restore(primask);
+
+    return systick_base + (uint64_t)ticks * systick_period + (systick_period - 1 - cvr);
+}
+
+/**
+ * @brief Returns microseconds elapsed since reset, at the current core clock.
+ */
+uint64_t time_us(void)
+{
+    return time_cycles() / (sysclk_get_hz() / 1000000);
+}
+
+/**
+ * @brief Returns the number of SYSTICK_HZ ticks since systick_init().
+ */
+uint32_t time_ticks(void)
+{
+    return systick_ticks;
+}
+
+/**
+ * @brief Converts a cycle count measured at 'hz' into microseconds.
+ */
+uint32_t time_cycles_to_us(uint32_t cycles, uint32_t hz)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000) / hz);
+}
+
+/**
+ * @brief Records the end of a boot phase at the current time and clock.
+ */
+void boot_stamp(int phase)
+{
+    boot_stamp_at(phase, (uint32_t)time_cycles(), sysclk_get_hz());
+}
+
+/**
+ * @brief Records the end of a boot phase from an earlier timestamp.
+ *
+ * reset_handler measures .data/.bss before .bss is usable and reports the
+ * values here afterwards.
+ * @param hz Core clock that was in effect while the phase ran.
+ */
+void boot_stamp_at(int phase, uint32_t cycles, uint32_t hz)
+{
+    if (phase < 0 || phase >= BOOT_PHASE_COUNT || boot_cycles[phase] != 0) {
+        return;
+    }
+    boot_cycles[phase] = cycles;
+    boot_hz[phase] = hz;
+}
+
+/**
+ * @brief Prints the boot phase timings for the 'bootinfo' command.
+ *
+ * Each phase is converted to microseconds with the clock in effect when it
+ * started, since the core runs at 12 MHz until sysclk_init() switches to the PLL.
+ */
+void boot_profile_print(void)
+{
+    char num[12];
+    uint32_t prev_cycles = 0;
+    uint32_t prev_hz = SYSCLK_PIOSC_HZ;
+    uint32_t total_us = 0;
+
+    print_str("Boot profile (since reset):\n");
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        print_str("  "); print_str(boot_phase_names[i]); print_str(": ");
+        if (boot_cycles[i] == 0) {
+            print_str("not recorded\n");
+            continue;
+        }
+        uint32_t cycles = boot_cycles[i] - prev_cycles;
+        uint32_t us = time_cycles_to_us(cycles, prev_hz);
+        total_us += us;
+        itoa(cycles, num); print_str(num); print_str(" cycles | ");
+        itoa(us, num); print_str(num); print_str(" us\n");
+        prev_cycles = boot_cycles[i];
+        prev_hz = boot_hz[i];
+    }
+    print_str("  Total: "); itoa(total_us, num); print_str(num); print_str(" us\n");
+    print_str("Uptime: "); itoa((uint32_t)(time_us() / 1000), num); print_str(num); print_str(" ms\n");
+}
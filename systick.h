@@ -0,0 +1,41 @@
+#ifndef __SYSTICK_H_
+#define __SYSTICK_H_
+
+#include <stdint.h>
+
+/*
+ * Timebase monotonic berbasis SysTick.
+ * SysTick sudah berjalan bebas sejak awal reset_handler, jadi time_cycles()
+ * selalu dihitung dari reset, baik sebelum maupun sesudah systick_init()
+ * mengubahnya menjadi tick periodik SYSTICK_HZ.
+ */
+#define SYSTICK_HZ 1000 // Frekuensi tick (1 ms)
+
+// Fase boot yang dicatat untuk perintah 'bootinfo', sesuai urutan terjadinya.
+enum {
+    BOOT_PHASE_DATA,    // Salin .data (dan .ramfunc) dari Flash
+    BOOT_PHASE_BSS,     // Nol-kan .bss
+    BOOT_PHASE_CLOCK,   // sysclk_init()
+    BOOT_PHASE_UART,    // uart0_init()
+    BOOT_PHASE_HEAP,    // malloc_init()
+    BOOT_PHASE_PROMPT,  // Prompt pertama tampil
+    BOOT_PHASE_COUNT
+};
+
+void systick_start_free_running(void);
+uint32_t systick_boot_cycles(void);
+void systick_init(void);
+void systick_isr(void);
+uint32_t systick_suppress(uint32_t ticks);
+uint32_t systick_resume(uint32_t *suppressed);
+
+uint64_t time_cycles(void);
+uint64_t time_us(void);
+uint32_t time_ticks(void);
+uint32_t time_cycles_to_us(uint32_t cycles, uint32_t hz);
+
+void boot_stamp(int phase);
+void boot_stamp_at(int phase, uint32_t cycles, uint32_t hz);
+void boot_profile_print(void);
+
+#endif // __SYSTICK_H_
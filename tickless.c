@@ -0,0 +1,105 @@
+#include "reg.h"
+#include "cpu.h"
+#include "sched.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "timer.h"
+#include "tickless.h"
+
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+static int tickless_on = 1;
+static uint32_t tickless_sleeps;         // Sleeps with the tick suppressed
+static uint32_t tickless_early_wakeups;  // ...ended by another interrupt before the deadline
+static uint32_t tickless_suppressed;     // SysTick interrupts that never happened
+static uint32_t tickless_plain_sleeps;   // Ordinary WFI sleeps (tick still running)
+static uint64_t tickless_sleep_cycles;   // Total time asleep in the idle task
+
+/**
+ * @brief Sleeps the core once, called in a loop by the idle task.
+ *
+ * Computes how many ticks nothing needs the CPU: the earliest sleeping task
+ * and the earliest software timer (minus one tick, since Timer0 and SysTick
+ * are not in phase). If that is at least TICKLESS_MIN_TICKS, the SysTick
+ * interrupts in between are suppressed and Timer0 is masked; otherwise this
+ * is a plain WFI. Everything runs with interrupts disabled, so the handler of
+ * whatever woke the core only runs after the timebase has been corrected.
+ */
+void tickless_idle(void)
+{
+    uint32_t primask = irq_save();
+
+    uint32_t budget = sched_ticks_until_wake();
+    uint32_t timer_ticks = timer_idle_ticks();
+    if (timer_ticks != UINT32_MAX) {
+        timer_ticks = (timer_ticks > 0) ? timer_ticks - 1 : 0;
+        if (timer_ticks < budget) budget = timer_ticks;
+    }
+
+    if (tickless_on && budget >= TICKLESS_MIN_TICKS &&
+        (*(SCB_ICSR) & SCB_ICSR_PENDSVSET) == 0) {
+        timer_suspend();
+        uint32_t planned = systick_suppress(budget);
+        if (planned != 0) {
+            uint32_t suppressed;
+            cpu_wfi();
+            uint32_t elapsed = systick_resume(&suppressed);
+            timer_resume(elapsed);
+
+            tickless_sleeps++;
+            tickless_suppressed += suppressed;
+            tickless_sleep_cycles += elapsed;
+            if (suppressed + 1 < planned) {
+                tickless_early_wakeups++;
+            }
+            irq_restore(primask);
+            return;
+        }
+        timer_resume(0);
+    }
+
+    uint64_t start = time_cycles();
+    cpu_wfi();
+    tickless_sleep_cycles += time_cycles() - start;
+    tickless_plain_sleeps++;
+    irq_restore(primask);
+}
+
+/**
+ * @brief Turns tick suppression on or off; the idle task falls back to plain WFI.
+ */
+void tickless_enable(int on)
+{
+    tickless_on = on;
+}
+
+/**
+ * @brief Returns 1 if tick suppression is enabled.
+ */
+int tickless_enabled(void)
+{
+    return tickless_on;
+}
+
+/**
+ * @brief Prints idle sleep statistics ('tickless' command).
+ */
+void tickless_print_stats(void)
+{
+    char num[12];
+    uint64_t total = time_cycles();
+    uint32_t cycles_per_ms = sysclk_get_hz() / 1000;
+
+    if (total == 0) total = 1;
+
+    print_str("Tickless idle: "); print_str(tickless_on ? "on" : "off");
+    print_str(" | Sleeps: "); itoa(tickless_sleeps, num); print_str(num);
+    print_str(" | Early wakeups: "); itoa(tickless_early_wakeups, num); print_str(num);
+    print_str(" | Plain WFI: "); itoa(tickless_plain_sleeps, num); print_str(num);
+    print_str("\n");
+    print_str("  Ticks suppressed: "); itoa(tickless_suppressed, num); print_str(num);
+    print_str(" | Asleep: "); itoa((uint32_t)(tickless_sleep_cycles / cycles_per_ms), num); print_str(num);
+    print_str(" ms ("); itoa((uint32_t)(tickless_sleep_cycles * 100 / total), num); print_str(num);
+    print_str("% of uptime)\n");
+}
@@ -0,0 +1,21 @@
+#ifndef __TICKLESS_H_
+#define __TICKLESS_H_
+
+#include <stdint.h>
+
+/*
+ * Idle tickless.
+ * Saat tidak ada task yang siap, task idle memprogram ulang SysTick agar baru
+ * interrupt pada timeout terdekat (task_sleep atau software timer) dan
+ * interrupt Timer0 di-mask, lalu core tidur dengan WFI. Setelah bangun, oleh
+ * interrupt apa pun (mis. UART RX), tick yang terlewat ditambahkan ke
+ * time_ticks() dan timer_now() sehingga timebase tetap benar.
+ */
+#define TICKLESS_MIN_TICKS  2  // Tidur lebih pendek dari ini memakai WFI biasa
+
+void tickless_idle(void);
+void tickless_enable(int on);
+int tickless_enabled(void);
+void tickless_print_stats(void);
+
+#endif // __TICKLESS_H_
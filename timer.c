@@ -0,0 +1,591 @@
+#include "reg.h"
+#include "cpu.h"
+#include "nvic.h"
+#include "pool.h"
+#include "sched.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "timer.h"
+#include "trace.h"
+
+void *malloc(size_t size);
+void free(void *ptr);
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+#define TIMER_SLOT_MASK   (TIMER_SLOTS - 1)
+#define MS_TO_TIMER_TICKS(ms) ((uint32_t)(((uint64_t)(ms) * TIMER_HZ) / 1000))
+#define TIMER_PRINT_MAX   16 // Timers listed by 'timers'
+#define TIMER_DEMO_MAX    8  // Timers the 'timer' shell command can run at once
+
+static SoftTimer *timer_wheel[TIMER_LEVELS][TIMER_SLOTS];
+static SoftTimer *timer_expired;           // Due timers waiting for the timer task
+static volatile uint32_t timer_hw_ticks;   // Timer0 interrupts since timer_init()
+static uint32_t wheel_now;                 // Last tick processed by the wheel
+static volatile uint32_t timer_active;     // Timers in the wheel or the expired list
+static uint32_t timer_peak_active;
+static uint32_t timer_dispatched;          // Callbacks run
+static uint32_t timer_max_lag;             // Most ticks the wheel ever fell behind Timer0
+static Task *timer_task_ref;
+
+static Pool timer_demo_pool;
+static SoftTimer *timer_demo[TIMER_DEMO_MAX];
+
+/**
+ * @brief Pushes a timer onto the front of a slot list. Interrupts must be disabled.
+ */
+static void timer_link(SoftTimer **head, SoftTimer *t)
+{
+    t->next = *head;
+    if (t->next != NULL) {
+        t->next->pprev = &t->next;
+    }
+    *head = t;
+    t->pprev = head;
+}
+
+/**
+ * @brief Removes a timer from whatever list it is on in O(1).
+ *        Interrupts must be disabled.
+ */
+static void timer_unlink(SoftTimer *t)
+{
+    *t->pprev = t->next;
+    if (t->next != NULL) {
+        t->next->pprev = t->pprev;
+    }
+    t->next = NULL;
+    t->pprev = NULL;
+}
+
+/**
+ * @brief Files a timer into the wheel slot for its expiry time.
+ *
+ * The level is picked from the highest set bit of the remaining ticks with
+ * CLZ, so placement costs the same for any delay. Delays beyond
+ * TIMER_MAX_DELTA are parked in the top level and re-filed when that slot
+ * cascades. Interrupts must be disabled.
+ * @param min_delta Earliest slot, relative to wheel_now, for an overdue timer:
+ *                  0 while cascading (the current slot is processed next),
+ *                  1 otherwise (the current slot has already been processed).
+ */
+static void timer_enqueue(SoftTimer *t, uint32_t min_delta)
+{
+    uint32_t expires = t->expires;
+    uint32_t delta = expires - wheel_now;
+
+    if ((int32_t)delta < (int32_t)min_delta) {
+        delta = min_delta;
+        expires = wheel_now + min_delta;
+    } else if (delta > TIMER_MAX_DELTA) {
+        delta = TIMER_MAX_DELTA;
+        expires = wheel_now + TIMER_MAX_DELTA;
+    }
+
+    uint32_t level = (31 - cpu_clz(delta | 1)) / TIMER_SLOT_BITS;
+    uint32_t slot = (expires >> (level * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK;
+    timer_link(&timer_wheel[level][slot], t);
+}
+
+/**
+ * @brief Re-files every timer of one slot into the levels below it.
+ *
+ * Interrupts are only masked per timer, so a large slot does not add to
+ * interrupt latency.
+ */
+static void timer_cascade(uint32_t level, uint32_t slot)
+{
+    SoftTimer **head = &timer_wheel[level][slot];
+    while (1) {
+        uint32_t primask = irq_save();
+        SoftTimer *t = *head;
+        if (t == NULL) {
+            irq_restore(primask);
+            return;
+        }
+        timer_unlink(t);
+        timer_enqueue(t, 0);
+        irq_restore(primask);
+    }
+}
+
+/**
+ * @brief Advances the wheel by one tick: cascades higher levels whose turn
+ *        it is and moves the due timers to the expired list.
+ *
+ * An empty wheel jumps straight to the current tick instead. Timers in the
+ * level 0 slot are checked against their expiry time, so one filed against a
+ * newer wheel_now by a concurrent timer_start() is re-filed rather than fired
+ * early.
+ */
+static void timer_advance(void)
+{
+    uint32_t primask = irq_save();
+    if (timer_active == 0) {
+        wheel_now = timer_hw_ticks;
+        irq_restore(primask);
+        return;
+    }
+    uint32_t now = ++wheel_now;
+    irq_restore(primask);
+
+    for (uint32_t level = 1; level < TIMER_LEVELS; level++) {
+        uint32_t shift = level * TIMER_SLOT_BITS;
+        if ((now & ((1u << shift) - 1)) != 0) {
+            break;
+        }
+        timer_cascade(level, (now >> shift) & TIMER_SLOT_MASK);
+    }
+
+    SoftTimer **head = &timer_wheel[0][now & TIMER_SLOT_MASK];
+    while (1) {
+        primask = irq_save();
+        SoftTimer *t = *head;
+        if (t == NULL) {
+            irq_restore(primask);
+            break;
+        }
+        timer_unlink(t);
+        if ((int32_t)(t->expires - now) > 0) {
+            timer_enqueue(t, 1);
+        } else {
+            timer_link(&timer_expired, t);
+        }
+        irq_restore(primask);
+    }
+}
+
+/**
+ * @brief Runs the callbacks of all expired timers in task context.
+ *
+ * Periodic timers are re-armed from their previous expiry (no drift) before
+ * the callback runs, so the callback may cancel or restart its own timer.
+ */
+static void timer_run_expired(void)
+{
+    while (1) {
+        uint32_t primask = irq_save();
+        SoftTimer *t = timer_expired;
+        if (t == NULL) {
+            irq_restore(primask);
+            return;
+        }
+        timer_unlink(t);
+        if (t->period != 0) {
+            t->expires += t->period;
+            timer_enqueue(t, 1);
+        } else {
+            timer_active--;
+        }
+        TimerCallback callback = t->callback;
+        void *arg = t->arg;
+        t->fired++;
+        irq_restore(primask);
+
+        callback(arg);
+        timer_dispatched++;
+    }
+}
+
+/**
+ * @brief Timer task: catches the wheel up with Timer0 and dispatches callbacks.
+ *        Blocks while no timer is active.
+ */
+static void timer_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        uint32_t primask = irq_save();
+        if (wheel_now == timer_hw_ticks && timer_expired == NULL) {
+            sched_block();
+            irq_restore(primask);
+            continue;
+        }
+        irq_restore(primask);
+
+        uint32_t lag = timer_hw_ticks - wheel_now;
+        if (lag > timer_max_lag) {
+            timer_max_lag = lag;
+        }
+        while (wheel_now != timer_hw_ticks) {
+            timer_advance();
+        }
+        timer_run_expired();
+    }
+}
+
+/**
+ * @brief Timer0A interrupt: counts the tick and wakes the timer task if any
+ *        timer is active. All wheel work happens in the task.
+ */
+RAMFUNC void timer0a_isr(void)
+{
+    *(TIMER0_GPTMICR) = GPTM_ICR_TATOCINT;
+    timer_hw_ticks++;
+    TRACE(TRACE_EV_TIMER_IRQ, timer_hw_ticks, timer_active);
+    if (timer_active != 0) {
+        sched_wake(timer_task_ref);
+    }
+}
+
+/**
+ * @brief Returns the Timer0 ticks the core may sleep before the wheel needs
+ *        the timer task again, UINT32_MAX if no timer is active.
+ *
+ * The result is a lower bound: for levels above 0 it is the time the first
+ * occupied slot cascades, which is never later than any expiry in it.
+ * Interrupts must be disabled.
+ */
+uint32_t timer_idle_ticks(void)
+{
+    if (timer_active == 0) {
+        return UINT32_MAX;
+    }
+    if (timer_expired != NULL || wheel_now != timer_hw_ticks) {
+        return 0;
+    }
+
+    uint32_t best = UINT32_MAX;
+    for (uint32_t level = 0; level < TIMER_LEVELS; level++) {
+        uint32_t shift = level * TIMER_SLOT_BITS;
+        uint32_t base = wheel_now >> shift;
+        for (uint32_t i = 1; i <= TIMER_SLOTS; i++) {
+            if (timer_wheel[level][(base + i) & TIMER_SLOT_MASK] != NULL) {
+                uint32_t delta = ((base + i) << shift) - wheel_now;
+                if (delta < best) best = delta;
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+static uint32_t timer_suspend_tar; // Cycles to the next Timer0 timeout at timer_suspend()
+
+/**
+ * @brief Masks the Timer0 interrupt for a tickless sleep. The counter keeps
+ *        running. Interrupts must be disabled.
+ */
+void timer_suspend(void)
+{
+    *(TIMER0_GPTMIMR) &= ~GPTM_IMR_TATOIM;
+    timer_suspend_tar = *(TIMER0_GPTMTAR);
+}
+
+/**
+ * @brief Unmasks the Timer0 interrupt after a tickless sleep and adds the
+ *        timeouts that happened while it was masked.
+ *
+ * The count comes from the sleep length, corrected with the current counter
+ * value so timeouts since the SysTick reading are not lost. The status is
+ * cleared before the counter is read: any later timeout interrupts normally.
+ * Interrupts must be disabled.
+ * @param elapsed Core cycles since timer_suspend(), as measured by SysTick.
+ */
+void timer_resume(uint32_t elapsed)
+{
+    uint32_t load = *(TIMER0_GPTMTAILR) + 1;
+
+    *(TIMER0_GPTMICR) = GPTM_ICR_TATOCINT;
+    uint32_t tar = *(TIMER0_GPTMTAR);
+    elapsed += (timer_suspend_tar - tar - elapsed % load + 2 * load) % load;
+
+    uint32_t fires = (elapsed >= timer_suspend_tar) ? 1 + (elapsed - timer_suspend_tar) / load : 0;
+    timer_hw_ticks += fires;
+    *(TIMER0_GPTMIMR) |= GPTM_IMR_TATOIM;
+
+    if (fires != 0 && timer_active != 0) {
+        sched_wake(timer_task_ref);
+    }
+}
+
+/**
+ * @brief Starts Timer0A as a periodic TIMER_HZ interrupt and creates the timer task.
+ *        Call after sched_init().
+ */
+void timer_init(void)
+{
+    *(SYSCTL_RCGC1) |= SYSCTL_RCGC1_TIMER0;
+    (void)*(SYSCTL_RCGC1); // Give the peripheral clock a few cycles to start.
+
+    *(TIMER0_GPTMCTL) &= ~GPTM_CTL_TAEN;
+    *(TIMER0_GPTMCFG) = GPTM_CFG_32BIT_TIMER;
+    *(TIMER0_GPTMTAMR) = GPTM_TAMR_TAMR_PERIODIC;
+    *(TIMER0_GPTMTAILR) = sysclk_cycles_per(TIMER_HZ) - 1;
+    *(TIMER0_GPTMICR) = GPTM_ICR_TATOCINT;
+    *(TIMER0_GPTMIMR) |= GPTM_IMR_TATOIM;
+
+    pool_create(&timer_demo_pool, "timers", sizeof(SoftTimer), TIMER_DEMO_MAX);
+    timer_task_ref = task_create("timer", timer_task, NULL, TIMER_TASK_PRIORITY, TIMER_STACK_SIZE);
+
+    nvic_enable_irq(IRQ_TIMER0A);
+    *(TIMER0_GPTMCTL) |= GPTM_CTL_TAEN;
+}
+
+/**
+ * @brief Initialises a timer. It stays inactive until timer_start().
+ */
+void timer_setup(SoftTimer *t, const char *name, TimerCallback callback, void *arg)
+{
+    t->next = NULL;
+    t->pprev = NULL;
+    t->expires = 0;
+    t->period = 0;
+    t->callback = callback;
+    t->arg = arg;
+    t->name = name;
+    t->fired = 0;
+}
+
+/**
+ * @brief Arms a timer in O(1), restarting it if it is already active.
+ *        Safe to call from an ISR or from the timer's own callback.
+ * @param delay_ms  Time until the first expiry; 0 fires on the next tick.
+ * @param period_ms Interval for periodic timers, 0 for a one-shot timer.
+ */
+void timer_start(SoftTimer *t, uint32_t delay_ms, uint32_t period_ms)
+{
+    uint32_t primask = irq_save();
+    if (t->pprev != NULL) {
+        timer_unlink(t);
+        timer_active--;
+    }
+    if (timer_active == 0) {
+        wheel_now = timer_hw_ticks; // Nothing to process in between.
+    }
+    t->expires = timer_hw_ticks + MS_TO_TIMER_TICKS(delay_ms);
+    t->period = MS_TO_TIMER_TICKS(period_ms);
+    if (period_ms != 0 && t->period == 0) {
+        t->period = 1;
+    }
+    timer_enqueue(t, 1);
+    timer_active++;
+    if (timer_active > timer_peak_active) {
+        timer_peak_active = timer_active;
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief Deactivates a timer in O(1). Its callback will not run afterwards
+ *        unless it is already executing.
+ * @return 1 if the timer was active, 0 otherwise.
+ */
+int timer_cancel(SoftTimer *t)
+{
+    uint32_t primask = irq_save();
+    if (t->pprev == NULL) {
+        irq_restore(primask);
+        return 0;
+    }
+    timer_unlink(t);
+    timer_active--;
+    irq_restore(primask);
+    return 1;
+}
+
+/**
+ * @brief Returns 1 if the timer is armed.
+ */
+int timer_pending(const SoftTimer *t)
+{
+    return t->pprev != NULL;
+}
+
+/**
+ * @brief Returns the number of Timer0 ticks since timer_init().
+ */
+uint32_t timer_now(void)
+{
+    return timer_hw_ticks;
+}
+
+/**
+ * @brief Lists active timers and wheel statistics ('timers' command).
+ *
+ * Entries are copied with interrupts masked, one slot at a time, and
+ * printed afterwards.
+ */
+void timer_print(void)
+{
+    struct {
+        const char *name;
+        int32_t due;
+        uint32_t period;
+        uint32_t fired;
+        uint8_t level;
+    } list[TIMER_PRINT_MAX];
+    uint32_t listed = 0, total = 0;
+    char num[12];
+
+    for (uint32_t level = 0; level < TIMER_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < TIMER_SLOTS; slot++) {
+            uint32_t primask = irq_save();
+            for (SoftTimer *t = timer_wheel[level][slot]; t != NULL; t = t->next) {
+                if (listed < TIMER_PRINT_MAX) {
+                    list[listed].name = t->name;
+                    list[listed].due = (int32_t)(t->expires - timer_hw_ticks);
+                    list[listed].period = t->period;
+                    list[listed].fired = t->fired;
+                    list[listed].level = (uint8_t)level;
+                    listed++;
+                }
+                total++;
+            }
+            irq_restore(primask);
+        }
+    }
+
+    print_str("Timer wheel: tick "); itoa(timer_hw_ticks, num); print_str(num);
+    print_str(" | Active: "); itoa(timer_active, num); print_str(num);
+    print_str(" | Peak: "); itoa(timer_peak_active, num); print_str(num);
+    print_str(" | Fired: "); itoa(timer_dispatched, num); print_str(num);
+    print_str(" | Max lag: "); itoa(timer_max_lag, num); print_str(num); print_str(" ticks\n");
+
+    for (uint32_t i = 0; i < listed; i++) {
+        print_str("  "); print_str(list[i].name != NULL ? list[i].name : "?");
+        print_str(" | Due in: "); itoa(list[i].due > 0 ? list[i].due : 0, num); print_str(num);
+        print_str(" ms | Period: "); itoa(list[i].period, num); print_str(num);
+        print_str(" ms | Fired: "); itoa(list[i].fired, num); print_str(num);
+        print_str(" | Level: "); itoa(list[i].level, num); print_str(num);
+        print_str("\n");
+    }
+    if (total > listed) {
+        print_str("  ... and "); itoa(total - listed, num); print_str(num); print_str(" more\n");
+    }
+}
+
+static void timer_bench_callback(void *arg)
+{
+    (void)arg;
+}
+
+/**
+ * @brief Measures timer_start()/timer_cancel() cost at two wheel populations
+ *        ('timerbench' command). O(1) operations cost the same at both sizes.
+ * @param count Number of timers armed at the larger size.
+ */
+void timer_bench(uint32_t count)
+{
+    char num[12];
+    uint32_t sizes[2];
+
+    if (count < 10) count = 10;
+    sizes[0] = count / 10;
+    sizes[1] = count;
+
+    SoftTimer *timers = malloc(count * sizeof(SoftTimer));
+    if (timers == NULL) {
+        print_str("Error: Not enough heap for the timers.\n");
+        return;
+    }
+
+    print_str("Timer wheel start/cancel cost:\n");
+    for (int s = 0; s < 2; s++) {
+        uint32_t n = sizes[s];
+        for (uint32_t i = 0; i < n; i++) {
+            timer_setup(&timers[i], "bench", timer_bench_callback, NULL);
+        }
+
+        // Spread the delays from 1 s up to an hour so every level is used.
+        uint64_t t0 = time_cycles();
+        for (uint32_t i = 0; i < n; i++) {
+            timer_start(&timers[i], 1000 + (i * 7919u) % 3600000u, 0);
+        }
+        uint32_t start_cycles = (uint32_t)(time_cycles() - t0);
+
+        t0 = time_cycles();
+        for (uint32_t i = 0; i < n; i++) {
+            timer_cancel(&timers[i]);
+        }
+        uint32_t cancel_cycles = (uint32_t)(time_cycles() - t0);
+
+        print_str("  "); itoa(n, num); print_str(num);
+        print_str(" timers | start: "); itoa(start_cycles / n, num); print_str(num);
+        print_str(" cycles | cancel: "); itoa(cancel_cycles / n, num); print_str(num);
+        print_str(" cycles\n");
+    }
+    free(timers);
+}
+
+/**
+ * @brief Callback of the 'timer' shell command's timers. One-shot timers
+ *        return to the pool once they have fired.
+ *
+ * The timer is freed only if it is still in timer_demo[]; an entry removed
+ * by timer_demo_stop() belongs to the shell, which frees it instead.
+ */
+static void timer_demo_callback(void *arg)
+{
+    SoftTimer *t = arg;
+    char num[12];
+
+    print_str("[timer] "); print_str(t->name); print_str(" fired (");
+    itoa(t->fired, num); print_str(num); print_str(")\n");
+
+    if (t->period == 0) {
+        int owned = 0;
+        uint32_t primask = irq_save();
+        for (int i = 0; i < TIMER_DEMO_MAX; i++) {
+            if (timer_demo[i] == t) {
+                timer_demo[i] = NULL;
+                owned = 1;
+            }
+        }
+        irq_restore(primask);
+        if (owned) {
+            pool_free(&timer_demo_pool, t);
+        }
+    }
+}
+
+/**
+ * @brief Starts a timer that prints a line when it fires ('timer' command).
+ * @return 0 on success, -1 if TIMER_DEMO_MAX timers are already running.
+ */
+int timer_demo_start(uint32_t delay_ms, uint32_t period_ms)
+{
+    SoftTimer *t = pool_alloc(&timer_demo_pool);
+    if (t == NULL) {
+        return -1;
+    }
+    timer_setup(t, period_ms != 0 ? "periodic" : "one-shot", timer_demo_callback, t);
+
+    uint32_t primask = irq_save();
+    for (int i = 0; i < TIMER_DEMO_MAX; i++) {
+        if (timer_demo[i] == NULL) {
+            timer_demo[i] = t;
+            break;
+        }
+    }
+    irq_restore(primask);
+
+    timer_start(t, delay_ms, period_ms);
+    return 0;
+}
+
+/**
+ * @brief Cancels every timer started by the 'timer' command.
+ *
+ * A timer is taken out of timer_demo[] and freed here only if the cancel
+ * succeeded. A one-shot timer that already fired stays in the table, and
+ * its callback (in the higher-priority timer task) frees it.
+ */
+void timer_demo_stop(void)
+{
+    for (int i = 0; i < TIMER_DEMO_MAX; i++) {
+        uint32_t primask = irq_save();
+        SoftTimer *t = timer_demo[i];
+        if (t != NULL && timer_cancel(t)) {
+            timer_demo[i] = NULL;
+        } else {
+            t = NULL;
+        }
+        irq_restore(primask);
+
+        if (t != NULL) {
+            pool_free(&timer_demo_pool, t);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef __TIMER_H_
+#define __TIMER_H_
+
+#include <stdint.h>
+
+/*
+ * Software timer berbasis timing wheel hierarkis, digerakkan oleh Timer0.
+ * - Timer0 berdetak TIMER_HZ kali per detik; satu tick wheel = 1 ms.
+ * - TIMER_LEVELS level x TIMER_SLOTS slot. Timer dengan sisa < 64 tick ada di
+ *   level 0, < 64^2 di level 1, dst. Isi satu slot level atas dipindah
+ *   (cascade) ke level bawah saat indeks level di bawahnya kembali ke 0.
+ * - Start dan cancel O(1): list intrusif (next + pprev) per slot, tanpa alokasi.
+ *   Jumlah timer hanya dibatasi memori pemanggil.
+ * - Callback dijalankan oleh task 'timer', bukan di ISR, jadi boleh memakai
+ *   print_str, malloc, dsb.
+ */
+#define TIMER_HZ             1000
+#define TIMER_LEVELS         4
+#define TIMER_SLOT_BITS      6
+#define TIMER_SLOTS          (1 << TIMER_SLOT_BITS)
+#define TIMER_MAX_DELTA      ((1u << (TIMER_LEVELS * TIMER_SLOT_BITS)) - 1) // ~4.6 jam pada 1 kHz
+#define TIMER_TASK_PRIORITY  2    // Di atas shell agar callback tepat waktu
+#define TIMER_STACK_SIZE     1024
+
+typedef void (*TimerCallback)(void *arg);
+
+typedef struct SoftTimer {
+    struct SoftTimer *next;    // Timer berikutnya di slot yang sama
+    struct SoftTimer **pprev;  // Pointer yang menunjuk ke timer ini, NULL = tidak aktif
+    uint32_t expires;          // Tick wheel saat jatuh tempo
+    uint32_t period;           // Tick antar pemicu, 0 = one-shot
+    TimerCallback callback;
+    void *arg;
+    const char *name;          // Nama untuk perintah 'timers'
+    uint32_t fired;            // Berapa kali callback sudah dipanggil
+} SoftTimer;
+
+void timer_init(void);
+void timer_setup(SoftTimer *t, const char *name, TimerCallback callback, void *arg);
+void timer_start(SoftTimer *t, uint32_t delay_ms, uint32_t period_ms);
+int timer_cancel(SoftTimer *t);
+int timer_pending(const SoftTimer *t);
+uint32_t timer_now(void);
+uint32_t timer_idle_ticks(void);
+void timer_suspend(void);
+void timer_resume(uint32_t elapsed);
+void timer_print(void);
+void timer_bench(uint32_t count);
+int timer_demo_start(uint32_t delay_ms, uint32_t period_ms);
+void timer_demo_stop(void);
+
+#endif // __TIMER_H_
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Decode an AmadeusOS 'trace dump' into a readable timeline.
+
+Capture the console output of 'trace dump' (e.g. from QEMU's serial log or a
+terminal log) and feed it to this script:
+
+    make qemu | tee console.log        # ... run 'trace start', work, 'trace dump'
+    tools/trace_decode.py console.log
+    tools/trace_decode.py --gap 500 console.log   # flag gaps longer than 500 us
+
+Event names are read from the TRACE_EV_* enum in trace.h, so the script stays
+in sync with the firmware. If several dumps are in the input, the last one is
+decoded unless --all is given.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+BEGIN = "--- trace begin ---"
+END = "--- trace end ---"
+
+# Exception numbers (IPSR) with a name; IRQ n is exception 16 + n.
+EXCEPTIONS = {
+    11: "SVCall",
+    14: "PendSV",
+    15: "SysTick",
+    16 + 5: "UART0",
+    16 + 19: "Timer0A",
+    16 + 28: "SysCtl",
+    16 + 29: "Flash",
+}
+
+# How to print the two argument words of each event.
+ARG_FORMATS = {
+    "MARK": lambda a, b, t: "value=%d" % a,
+    "SWITCH": lambda a, b, t: "%s -> %s" % (t.get(a, a), t.get(b, b)),
+    "WAKE": lambda a, b, t: "task=%s was=%s" % (t.get(a, a), TASK_STATES.get(b, b)),
+    "BLOCK": lambda a, b, t: "task=%s" % t.get(a, a),
+    "MALLOC": lambda a, b, t: "size=%d ptr=0x%08x%s" % (a, b, "" if b else " FAILED"),
+    "FREE": lambda a, b, t: "ptr=0x%08x" % a,
+    "REALLOC": lambda a, b, t: "0x%08x -> 0x%08x" % (a, b),
+    "UART_IRQ": lambda a, b, t: "mis=0x%03x tx_queued=%d" % (a, b),
+    "TIMER_IRQ": lambda a, b, t: "tick=%d active=%d" % (a, b),
+    "WORK_POST": lambda a, b, t: "item=0x%08x prio=%d" % (a, b),
+    "WORK_RUN": lambda a, b, t: "item=0x%08x cycles=%d" % (a, b),
+    "MBOX_SEND": lambda a, b, t: "mbox=0x%08x msg=0x%08x" % (a, b),
+    "MBOX_RECV": lambda a, b, t: "mbox=0x%08x msg=0x%08x" % (a, b),
+}
+
+TASK_STATES = {0: "ready", 1: "sleeping", 2: "blocked", 3: "dead"}
+
+
+def load_event_names(header):
+    """Returns {id: name} from the TRACE_EV_* enum in trace.h."""
+    names = {}
+    try:
+        with open(header) as f:
+            for m in re.finditer(r"TRACE_EV_(\w+)\s*=\s*(\d+)", f.read()):
+                names[int(m.group(2))] = m.group(1)
+    except OSError as e:
+        print("warning: %s; events are shown by number" % e, file=sys.stderr)
+    return names
+
+
+def split_dumps(lines):
+    """Yields the lines between each begin/end marker pair."""
+    dump = None
+    for line in lines:
+        line = line.strip()
+        if line.endswith(BEGIN):
+            dump = []
+        elif line == END and dump is not None:
+            yield dump
+            dump = None
+        elif dump is not None:
+            dump.append(line)
+
+
+def parse_dump(lines):
+    info = {"hz": 0, "lost": 0, "tasks": {}, "events": []}
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        key = fields[0]
+        try:
+            if key == "hz":
+                info["hz"] = int(fields[1])
+            elif key == "lost":
+                info["lost"] = int(fields[1])
+            elif key == "task":
+                info["tasks"][int(fields[1])] = " ".join(fields[2:])
+            elif key == "ev" and len(fields) == 7:
+                info["events"].append(tuple(int(x, 16) for x in fields[1:]))
+        except ValueError:
+            print("warning: skipping malformed line: %r" % line, file=sys.stderr)
+    return info
+
+
+def context_name(irq, task, tasks):
+    if irq == 0:
+        return tasks.get(task, "task %d" % task)
+    name = EXCEPTIONS.get(irq)
+    if name is None:
+        name = "IRQ%d" % (irq - 16) if irq >= 16 else "exc%d" % irq
+    return "[" + name + "]"
+
+
+def print_timeline(info, names, gap_us):
+    hz = info["hz"] or 1
+    tasks = info["tasks"]
+    events = info["events"]
+    if not events:
+        print("(no events)")
+        return
+
+    print("%d events at %d Hz, %d older events overwritten" % (len(events), hz, info["lost"]))
+    print("%12s %10s  %-10s %-10s %s" % ("time_us", "delta_us", "context", "event", "details"))
+
+    # Timestamps are the low 32 bits of the cycle counter; unwrap them with a
+    # signed delta, since an ISR that records in the middle of a task's record
+    # can leave two neighbours slightly out of order.
+    first = events[0][0]
+    prev_raw = first
+    elapsed = 0
+    prev_us = 0.0
+    counts = {}
+    for ts, ev_id, irq, task, a0, a1 in events:
+        d = (ts - prev_raw) & 0xFFFFFFFF
+        if d >= 1 << 31:
+            d -= 1 << 32
+        elapsed += d
+        prev_raw = ts
+        now_us = elapsed * 1e6 / hz
+        delta = now_us - prev_us
+        prev_us = now_us
+
+        name = names.get(ev_id, "EV%d" % ev_id)
+        counts[name] = counts.get(name, 0) + 1
+        fmt = ARG_FORMATS.get(name)
+        details = fmt(a0, a1, tasks) if fmt else "0x%08x 0x%08x" % (a0, a1)
+        flag = " <-- gap" if gap_us and delta > gap_us else ""
+        print("%12.1f %10.1f  %-10s %-10s %s%s" % (now_us, delta, context_name(irq, task, tasks),
+                                                   name, details, flag))
+
+    print()
+    print("Span: %.1f us" % prev_us)
+    for name in sorted(counts, key=counts.get, reverse=True):
+        print("  %-10s %d" % (name, counts[name]))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Decode an AmadeusOS 'trace dump'.")
+    parser.add_argument("log", nargs="?", help="console capture (default: stdin)")
+    parser.add_argument("--header", default=os.path.join(here, "..", "trace.h"),
+                        help="trace.h to read event names from")
+    parser.add_argument("--gap", type=float, default=0,
+                        help="flag events more than this many microseconds after the previous one")
+    parser.add_argument("--all", action="store_true", help="decode every dump in the input")
+    args = parser.parse_args()
+
+    names = load_event_names(args.header)
+    if args.log:
+        with open(args.log, errors="replace") as f:
+            dumps = list(split_dumps(f))
+    else:
+        dumps = list(split_dumps(sys.stdin))
+    if not dumps:
+        sys.exit("no '%s' ... '%s' block found" % (BEGIN, END))
+
+    for i, dump in enumerate(dumps if args.all else dumps[-1:]):
+        if i:
+            print()
+        print_timeline(parse_dump(dump), names, args.gap)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,105 @@
+#include "cpu.h"
+#include "kprintf.h"
+#include "sched.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "trace.h"
+
+void print_str(const char *str);
+
+static TraceEvent trace_buf[TRACE_ENTRIES];
+static volatile uint32_t trace_head; // Free-running count of claimed slots
+volatile uint32_t trace_active;      // Read by TRACE() on every call
+
+/**
+ * @brief Appends one event; the oldest is overwritten once the buffer is full.
+ *        Use TRACE() instead, which skips the call while tracing is stopped.
+ *
+ * Safe from any task or ISR. The slot is claimed with LDREX/STREX, so an
+ * interrupt that records its own event simply takes the next slot. The only
+ * masked section is the few cycles time_cycles() needs to read the counter;
+ * it is read before the claim so slot order stays close to time order.
+ */
+void trace_record(uint32_t id, uint32_t arg0, uint32_t arg1)
+{
+    uint32_t timestamp = (uint32_t)time_cycles();
+    uint32_t pos;
+    do {
+        pos = cpu_ldrex(&trace_head);
+    } while (cpu_strex(pos + 1, &trace_head) != 0);
+
+    TraceEvent *e = &trace_buf[pos & (TRACE_ENTRIES - 1)];
+    Task *current = task_current();
+    e->timestamp = timestamp;
+    e->id = (uint16_t)id;
+    e->irq = (uint8_t)cpu_ipsr();
+    e->task = (uint8_t)(current != NULL ? current->id : 0xFF);
+    e->arg0 = arg0;
+    e->arg1 = arg1;
+}
+
+/**
+ * @brief Empties the buffer and starts recording.
+ */
+void trace_start(void)
+{
+    trace_active = 0;
+    trace_head = 0;
+    trace_active = 1;
+}
+
+/**
+ * @brief Stops recording; the buffer keeps its contents.
+ */
+void trace_stop(void)
+{
+    trace_active = 0;
+}
+
+/**
+ * @brief Discards the recorded events without changing the recording state.
+ */
+void trace_clear(void)
+{
+    trace_head = 0;
+}
+
+/**
+ * @brief Prints the 'trace' status line.
+ */
+void trace_print_status(void)
+{
+    uint32_t head = trace_head;
+    uint32_t held = head < TRACE_ENTRIES ? head : TRACE_ENTRIES;
+
+    kprintf("Trace: %s | Events: %u/%u | Overwritten: %u | Recorded: %u\n",
+            trace_active ? "running" : "stopped", held, TRACE_ENTRIES,
+            head - held, head);
+}
+
+/**
+ * @brief Stops recording and prints the buffer, oldest event first, for
+ *        tools/trace_decode.py.
+ *
+ * The header gives the clock rate and the task names; each event is one line
+ * of hex fields: timestamp, id, irq, task, arg0, arg1.
+ */
+void trace_dump(void)
+{
+    trace_stop();
+
+    uint32_t head = trace_head;
+    uint32_t held = head < TRACE_ENTRIES ? head : TRACE_ENTRIES;
+
+    print_str("--- trace begin ---\n");
+    kprintf("hz %u\ncount %u\nlost %u\n", sysclk_get_hz(), held, head - held);
+    for (Task *t = sched_task_list(); t != NULL; t = t->all_next) {
+        kprintf("task %u %s\n", t->id & 0xFF, t->name);
+    }
+    for (uint32_t pos = head - held; pos != head; pos++) {
+        const TraceEvent *e = &trace_buf[pos & (TRACE_ENTRIES - 1)];
+        kprintf("ev %08x %04x %02x %02x %08x %08x\n",
+                e->timestamp, e->id, e->irq, e->task, e->arg0, e->arg1);
+    }
+    print_str("--- trace end ---\n");
+}
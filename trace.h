@@ -0,0 +1,67 @@
+#ifndef __TRACE_H_
+#define __TRACE_H_
+
+#include <stdint.h>
+
+/*
+ * Trace event biner di RAM (flight recorder).
+ * - Setiap event 16 byte: timestamp (siklus CPU, 32 bit bawah time_cycles()),
+ *   ID event, konteks (nomor exception dan task) dan dua argumen.
+ * - Ring berukuran tetap yang menimpa event terlama; slot diklaim dengan
+ *   LDREX/STREX sehingga aman dari ISR. Interrupt hanya dimatikan beberapa
+ *   siklus saat membaca timestamp (time_cycles()).
+ * - Saat trace berhenti, makro TRACE() hanya satu load dan satu cabang;
+ *   dengan TRACE_ENABLE=0 ('make TRACE=0') seluruhnya hilang saat kompilasi.
+ * - Perintah 'trace' menyalakan/mematikan dan mencetak isi buffer sebagai hex;
+ *   tools/trace_decode.py mengubahnya menjadi timeline yang bisa dibaca.
+ *   Nama event di skrip itu dibaca dari enum di bawah, jadi nilainya harus
+ *   tetap eksplisit.
+ */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+
+#define TRACE_ENTRIES  256  // Pangkat dua; 16 byte per event
+
+enum {
+    TRACE_EV_MARK      = 1,  // 'trace mark <n>': arg0 = n
+    TRACE_EV_SWITCH    = 2,  // Context switch: arg0 = id task lama, arg1 = id task baru
+    TRACE_EV_WAKE      = 3,  // sched_wake(): arg0 = id task, arg1 = state sebelumnya
+    TRACE_EV_BLOCK     = 4,  // sched_block(): arg0 = id task
+    TRACE_EV_MALLOC    = 5,  // arg0 = ukuran, arg1 = pointer (0 jika gagal)
+    TRACE_EV_FREE      = 6,  // arg0 = pointer
+    TRACE_EV_REALLOC   = 7,  // arg0 = pointer lama, arg1 = pointer baru
+    TRACE_EV_UART_IRQ  = 8,  // arg0 = UART0 MIS, arg1 = byte di ring TX
+    TRACE_EV_TIMER_IRQ = 9,  // arg0 = tick Timer0, arg1 = timer aktif
+    TRACE_EV_WORK_POST = 10, // Masuk antrian: arg0 = WorkItem*, arg1 = prioritas
+    TRACE_EV_WORK_RUN  = 11, // arg0 = WorkItem*, arg1 = siklus eksekusi
+    TRACE_EV_MBOX_SEND = 12, // arg0 = Mailbox*, arg1 = pesan
+    TRACE_EV_MBOX_RECV = 13  // arg0 = Mailbox*, arg1 = pesan
+};
+
+typedef struct TraceEvent {
+    uint32_t timestamp;      // time_cycles(), 32 bit bawah
+    uint16_t id;             // TRACE_EV_*
+    uint8_t irq;             // Nomor exception aktif (IPSR), 0 = thread mode
+    uint8_t task;            // ID task yang berjalan (8 bit bawah)
+    uint32_t arg0;
+    uint32_t arg1;
+} TraceEvent;
+
+extern volatile uint32_t trace_active;
+
+#define TRACE(id, a0, a1)                                               \
+    do {                                                                \
+        if (TRACE_ENABLE && trace_active) {                             \
+            trace_record((id), (uint32_t)(a0), (uint32_t)(a1));         \
+        }                                                               \
+    } while (0)
+
+void trace_record(uint32_t id, uint32_t arg0, uint32_t arg1);
+void trace_start(void);
+void trace_stop(void);
+void trace_clear(void);
+void trace_dump(void);
+void trace_print_status(void);
+
+#endif // __TRACE_H_
@@ -1,20 +1,59 @@
 #include "reg.h" // For UART register definitions
+#include "cpu.h" // For irq_save()/irq_restore()
+#include "sysclk.h" // For sysclk_get_hz()
+#include "nvic.h" // For nvic_enable_irq()
+#include "sched.h" // For blocking the reading task in uart0_getc()
+#include "ring.h" // Lock-free TX/RX rings
+#include "trace.h" // TRACE() in the interrupt handler
 #include <stddef.h> // For NULL
 
+int strlen(const char *s);
+
 // Define common ASCII control characters
 #define ASCII_CR    0x0D // Carriage Return (Enter key)
 #define ASCII_LF    0x0A // Line Feed (Newline)
 #define ASCII_BS    0x08 // Backspace
 #define ASCII_DEL   0x7F // Delete key (alternative to backspace)
 
+// Size of the software TX ring buffer (power of two, see ring.h).
+#define UART_TX_BUF_SIZE 256
+
+// What uart0_putc() does when the TX ring is full.
+#define UART_TX_BLOCK 0 // Wait for the interrupt handler to make room.
+#define UART_TX_DROP  1 // Discard the byte and count it in uart_tx_dropped.
+
+#ifndef UART_TX_FULL_POLICY
+#define UART_TX_FULL_POLICY UART_TX_BLOCK
+#endif
+
+// Size of the software RX ring buffer (power of two). Large enough to absorb
+// a pasted script while the shell is busy executing the previous line.
+#define UART_RX_BUF_SIZE 1024
+
+// TX: any task may print, so producers use the multi-producer ring; the ISR
+// (or the polled drain, with interrupts masked) is the only consumer.
+static char uart_tx_buf[UART_TX_BUF_SIZE];
+static uint8_t uart_tx_seq[UART_TX_BUF_SIZE];
+static Ring uart_tx_ring;
+static volatile uint32_t uart_tx_dropped;
+static int uart_tx_policy = UART_TX_FULL_POLICY;
+static int uart_tx_irq_ready;          // Set once uart0_irq_init() has run.
+
+// RX: the ISR produces, the task in uart0_getc() consumes.
+static char uart_rx_buf[UART_RX_BUF_SIZE];
+static Ring uart_rx_ring;
+static volatile uint32_t uart_rx_dropped; // Bytes lost because the software ring was full.
+static volatile uint32_t uart_rx_overruns; // Bytes lost in the hardware FIFO (DR overrun flag).
+static Task *volatile uart_rx_waiter;   // Task blocked in uart0_getc(), woken by the ISR.
+
 /**
- * @brief Sends a single character over UART0.
+ * @brief Sends a single character over UART0 by polling the hardware FIFO.
  *
- * This function waits until the UART transmit buffer (FIFO) is not full
- * before sending the character.
+ * This is the original blocking path. It is used before interrupts are set up,
+ * whenever interrupts are masked (e.g. inside panic()) and from handler mode.
  * @param c The character to send.
  */
-void uart0_putc(char c)
+static void uart0_putc_polled(char c)
 {
     // Wait until the Transmit FIFO is not full (TXFF flag is 0).
     while ((*(UART0_FR) & UART0_FR_TXFF) != 0);
@@ -22,19 +61,363 @@ void uart0_putc(char c)
     *(UART0_DR) = c;
 }
 
+/**
+ * @brief Returns 1 if the UART0 interrupt cannot be relied on to move data.
+ */
+static int uart0_must_poll(void)
+{
+    return !uart_tx_irq_ready || irq_disabled() || cpu_ipsr() != 0;
+}
+
+/**
+ * @brief Moves bytes from the ring into the hardware FIFO until it is full.
+ *
+ * Unmasks the TX interrupt while bytes remain queued and masks it again once
+ * the ring is empty. Called from the ISR, or with interrupts disabled.
+ */
+RAMFUNC static void uart0_tx_fill_fifo(void)
+{
+    while (1) {
+        char *data;
+        uint32_t n = ring_read_peek(&uart_tx_ring, (void **)&data);
+        uint32_t sent = 0;
+        while (sent < n && (*(UART0_FR) & UART0_FR_TXFF) == 0) {
+            *(UART0_DR) = data[sent++];
+        }
+        ring_read_release(&uart_tx_ring, sent);
+        if (sent == 0 || sent < n) {
+            break; // FIFO full, or nothing (more) committed yet.
+        }
+    }
+
+    if (ring_count(&uart_tx_ring) != 0) {
+        *(UART0_IM) |= UART0_INT_TX;
+    } else {
+        *(UART0_IM) &= ~UART0_INT_TX;
+    }
+}
+
+/**
+ * @brief Starts (or keeps) the interrupt-driven drain of the TX ring.
+ *
+ * The PL011 only raises the TX interrupt when the FIFO level crosses the
+ * trigger level, so the FIFO has to be primed: pending the UART0 interrupt
+ * lets the ISR do it, and keeps it the only consumer of the ring.
+ */
+static void uart0_tx_kick(void)
+{
+    nvic_set_pending(IRQ_UART0);
+}
+
+/**
+ * @brief Waits for the ISR to free space in (or drain) the TX ring.
+ *
+ * Tasks sleep for a tick rather than spin: the ISR stops at a slot claimed by
+ * a preempted lower-priority task, which must get the CPU to commit it.
+ */
+static void uart0_tx_wait(void)
+{
+    uart0_tx_kick();
+    if (sched_running()) {
+        task_sleep(1);
+    }
+}
+
+/**
+ * @brief Sends everything still queued in the ring by polling the FIFO.
+ *
+ * Keeps output ordered when switching from the buffered to the blocking path.
+ */
+static void uart0_tx_drain_polled(void)
+{
+    char c;
+    uint32_t primask = irq_save();
+    *(UART0_IM) &= ~UART0_INT_TX;
+    while (ring_pop(&uart_tx_ring, &c)) {
+        uart0_putc_polled(c);
+    }
+    irq_restore(primask);
+}
+
+/**
+ * @brief Queues one byte in the TX ring without starting the transmitter.
+ *
+ * Applies the full-buffer policy: either waits for the ISR to free a slot or
+ * drops the byte and counts it. Several tasks may print at once; the
+ * multi-producer ring lets them claim slots without masking interrupts.
+ * @return 1 if the byte was queued, 0 if it was dropped.
+ */
+static int uart0_tx_enqueue(char c)
+{
+    while (!ring_mp_push(&uart_tx_ring, &c)) {
+        if (uart_tx_policy == UART_TX_DROP) {
+            uart_tx_dropped++;
+            return 0;
+        }
+        uart0_tx_wait();
+    }
+    return 1;
+}
+
+/**
+ * @brief Queues 'len' bytes in the TX ring as few blocks as space allows.
+ *
+ * Same full-buffer policy as uart0_tx_enqueue(); with UART_TX_DROP the bytes
+ * that do not fit are counted as dropped.
+ */
+static void uart0_tx_enqueue_n(const char *buf, uint32_t len)
+{
+    while (len != 0) {
+        uint32_t n = ring_mp_push_n(&uart_tx_ring, buf, len);
+        buf += n;
+        len -= n;
+        if (len != 0) {
+            if (uart_tx_policy == UART_TX_DROP) {
+                uart_tx_dropped += len;
+                return;
+            }
+            uart0_tx_wait();
+        }
+    }
+}
+
+/**
+ * @brief Moves every byte waiting in the hardware RX FIFO into the RX ring.
+ *        Called from the ISR only.
+ */
+RAMFUNC static void uart0_rx_drain_fifo(void)
+{
+    while ((*(UART0_FR) & UART0_FR_RXFE) == 0) {
+        uint32_t data = *(UART0_DR);
+        char c = (char)data;
+        if (data & UART0_DR_OE) {
+            uart_rx_overruns++;
+        }
+        if (!ring_push(&uart_rx_ring, &c)) {
+            uart_rx_dropped++;
+        }
+    }
+}
+
+/**
+ * @brief UART0 interrupt handler: refills the TX FIFO from the ring buffer and
+ *        empties the RX FIFO into the RX ring.
+ *
+ * The RX interrupt fires when the FIFO reaches its trigger level; the receive
+ * time-out interrupt picks up the remaining bytes once the line goes idle.
+ */
+RAMFUNC void uart0_isr(void)
+{
+    uint32_t status = *(UART0_MIS);
+    TRACE(TRACE_EV_UART_IRQ, status, ring_count(&uart_tx_ring));
+
+    if (status & (UART0_INT_RX | UART0_INT_RT)) {
+        *(UART0_ICR) = UART0_INT_RX | UART0_INT_RT;
+        uart0_rx_drain_fifo();
+        if (uart_rx_waiter != NULL && ring_count(&uart_rx_ring) != 0) {
+            sched_wake(uart_rx_waiter);
+            uart_rx_waiter = NULL;
+        }
+    }
+
+    if (status & UART0_INT_TX) {
+        *(UART0_ICR) = UART0_INT_TX;
+    }
+    // Also runs when uart0_tx_kick() pended the interrupt with no status bit set.
+    uart0_tx_fill_fifo();
+}
+
+/**
+ * @brief Configures the UART0 FIFO trigger levels and enables its NVIC line.
+ *
+ * Until this is called every write goes through the polled path.
+ */
+void uart0_irq_init(void)
+{
+    ring_init(&uart_tx_ring, uart_tx_buf, uart_tx_seq, 1, UART_TX_BUF_SIZE);
+    ring_init(&uart_rx_ring, uart_rx_buf, NULL, 1, UART_RX_BUF_SIZE);
+    *(UART0_IFLS) = UART0_IFLS_TX_1_8 | UART0_IFLS_RX_1_2;
+    *(UART0_ICR) = UART0_INT_TX | UART0_INT_RX | UART0_INT_RT;
+    *(UART0_IM) = UART0_INT_RX | UART0_INT_RT;
+    nvic_enable_irq(IRQ_UART0);
+    uart_tx_irq_ready = 1;
+}
+
+/**
+ * @brief Programs the UART0 baud rate divisors from the current core clock.
+ *
+ * BRD = clock / (16 * baud); IBRD takes the integer part and FBRD the
+ * fraction in 1/64 steps, rounded to nearest. Must be called again whenever
+ * the system clock changes.
+ * @param baud The desired baud rate, e.g. 115200.
+ */
+void uart0_set_baud(uint32_t baud)
+{
+    // 64 * BRD = 4 * clock / baud; computed with one extra bit for rounding.
+    uint32_t div64 = ((sysclk_get_hz() * 8) / baud + 1) / 2;
+    uint32_t ctl = *(UART0_CTL);
+
+    *(UART0_CTL) = ctl & ~UART0_CTL_UARTEN;
+    *(UART0_IBRD) = div64 >> 6;
+    *(UART0_FBRD) = div64 & 0x3F;
+    *(UART0_LCRH) = *(UART0_LCRH); // A write to LCRH latches the new divisors.
+    *(UART0_CTL) = ctl;
+}
+
+/**
+ * @brief Selects what happens when the TX ring is full.
+ * @param drop 0 to block until space is available, 1 to drop and count bytes.
+ */
+void uart0_set_tx_policy(int drop)
+{
+    uart_tx_policy = drop ? UART_TX_DROP : UART_TX_BLOCK;
+}
+
+/**
+ * @brief Reports the TX ring state for the 'uart' shell command.
+ * @param queued  Receives the number of bytes still waiting in the ring.
+ * @param dropped Receives the number of bytes dropped because the ring was full.
+ * @return The current full-buffer policy (0 = block, 1 = drop).
+ */
+int uart0_tx_stats(uint32_t *queued, uint32_t *dropped)
+{
+    if (queued != NULL) *queued = ring_count(&uart_tx_ring);
+    if (dropped != NULL) *dropped = uart_tx_dropped;
+    return uart_tx_policy;
+}
+
+/**
+ * @brief Reports the RX ring state for the 'uart' shell command.
+ * @param buffered Receives the number of bytes waiting to be read.
+ * @param dropped  Receives the number of bytes lost because the ring was full.
+ * @param overruns Receives the number of hardware FIFO overruns seen.
+ */
+void uart0_rx_stats(uint32_t *buffered, uint32_t *dropped, uint32_t *overruns)
+{
+    if (buffered != NULL) *buffered = ring_count(&uart_rx_ring);
+    if (dropped != NULL) *dropped = uart_rx_dropped;
+    if (overruns != NULL) *overruns = uart_rx_overruns;
+}
+
+/**
+ * @brief Returns the number of received bytes that can be read without blocking.
+ */
+int uart0_rx_available(void)
+{
+    if (uart0_must_poll()) {
+        return (*(UART0_FR) & UART0_FR_RXFE) == 0;
+    }
+    return (int)ring_count(&uart_rx_ring);
+}
+
+/**
+ * @brief Waits until every queued byte has been handed to the hardware.
+ */
+void uart0_flush(void)
+{
+    if (uart0_must_poll()) {
+        uart0_tx_drain_polled();
+        return;
+    }
+    while (ring_count(&uart_tx_ring) != 0) {
+        uart0_tx_wait();
+    }
+}
+
+/**
+ * @brief Sends a single character over UART0.
+ *
+ * Queues the character in the TX ring and returns immediately; the UART0
+ * interrupt drains the ring in the background. Falls back to the blocking
+ * path when interrupts are unavailable.
+ * @param c The character to send.
+ */
+void uart0_putc(char c)
+{
+    if (uart0_must_poll()) {
+        uart0_tx_drain_polled();
+        uart0_putc_polled(c);
+        return;
+    }
+    uart0_tx_enqueue(c);
+    uart0_tx_kick();
+}
+
 /**
  * @brief Receives a single character from UART0.
  *
- * This function waits until the UART receive buffer (FIFO) is not empty
- * before reading the character. This is a blocking call.
+ * Takes the next byte from the RX ring. While it is empty the calling task
+ * blocks and the ISR wakes it, so other tasks keep running; before the
+ * scheduler starts it sleeps with WFI instead. The empty check and the block
+ * run with interrupts masked so a byte arriving in between is not missed.
+ * Without interrupts it polls the FIFO.
+ * This is a blocking call.
  * @return The character received.
  */
 char uart0_getc(void)
 {
-    // Wait until the Receive FIFO is not empty (RXFE flag is 0).
-    while ((*(UART0_FR) & UART0_FR_RXFE) != 0);
-    // Read the character from the UART Data Register.
-    return *(UART0_DR);
+    char c;
+
+    if (uart0_must_poll()) {
+        // Wait until the Receive FIFO is not empty (RXFE flag is 0).
+        while ((*(UART0_FR) & UART0_FR_RXFE) != 0);
+        // Read the character from the UART Data Register.
+        return *(UART0_DR);
+    }
+
+    while (!ring_pop(&uart_rx_ring, &c)) {
+        uint32_t primask = irq_save();
+        if (ring_count(&uart_rx_ring) == 0) {
+            if (sched_running()) {
+                uart_rx_waiter = task_current();
+                sched_block();
+            } else {
+                cpu_wfi();
+            }
+        }
+        irq_restore(primask); // The pending UART0 interrupt (or the task switch) runs here.
+    }
+    return c;
+}
+
+/**
+ * @brief Writes a buffer to the UART0 console, turning '\n' into CR LF.
+ *
+ * Each run of text between newlines is queued with one block copy, and the
+ * transmitter is started once for the whole buffer.
+ * @param buf Bytes to send (need not be null-terminated).
+ * @param len Number of bytes.
+ */
+void uart0_write(const char *buf, size_t len)
+{
+    static const char crlf[2] = { ASCII_CR, ASCII_LF };
+    const char *end = buf + len;
+
+    if (uart0_must_poll()) {
+        for (; buf < end; buf++) {
+            // Replace newline '\n' with carriage return + line feed for proper terminal display
+            if (*buf == '\n') {
+                uart0_putc(ASCII_CR);
+                uart0_putc(ASCII_LF);
+            } else {
+                uart0_putc(*buf);
+            }
+        }
+        return;
+    }
+
+    while (buf < end) {
+        const char *run = buf;
+        while (buf < end && *buf != '\n') {
+            buf++;
+        }
+        uart0_tx_enqueue_n(run, buf - run);
+        if (buf < end) {
+            uart0_tx_enqueue_n(crlf, 2);
+            buf++;
+        }
+    }
+    uart0_tx_kick();
 }
 
 /**
@@ -43,16 +426,7 @@ char uart0_getc(void)
  */
 void print_str(const char *str)
 {
-    while (*str != '\0') {
-        // Replace newline '\n' with carriage return + line feed for proper terminal display
-        if (*str == '\n') {
-            uart0_putc(ASCII_CR);
-            uart0_putc(ASCII_LF);
-        } else {
-            uart0_putc(*str);
-        }
-        str++;
-    }
+    uart0_write(str, strlen(str));
 }
 
 /**
@@ -73,14 +447,23 @@ void clear_screen(void)
  */
 void readline(char *buffer, int max_len)
 {
+    // Remembers a CR that ended the previous line, so the LF of a CRLF pair
+    // (common in pasted scripts) does not produce an extra empty line.
+    static int last_was_cr;
     int i = 0;
     char c;
 
     while (1) {
-        c = uart0_getc();
+        c = uart0_getc(); // Blocks until a byte is buffered.
+
+        if (c == ASCII_LF && last_was_cr) {
+            last_was_cr = 0;
+            continue;
+        }
+        last_was_cr = (c == ASCII_CR);
 
-        // If Enter key (Carriage Return) is pressed
-        if (c == ASCII_CR) {
+        // If Enter key (Carriage Return) or a bare Line Feed is received
+        if (c == ASCII_CR || c == ASCII_LF) {
             print_str("\n"); // Echo a newline to the terminal
             break;
         }
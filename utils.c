@@ -1,12 +1,39 @@
 #include <stdint.h>
 #include <stddef.h> // For NULL
+#include "kprintf.h"
+
+// Nonzero if any byte of the 32-bit word x is 0x00. Lets the string routines
+// test four characters per load instead of one.
+#define HAS_ZERO_BYTE(x) (((x) - 0x01010101u) & ~(x) & 0x80808080u)
 
 /**
  * @brief Compares two strings.
+ *
+ * When both strings share the same word alignment, equal words without a
+ * terminator are skipped four bytes at a time.
  * @return 0 if equal, <0 if s1 < s2, >0 if s1 > s2.
  */
 int strcmp(const char *s1, const char *s2)
 {
+    if ((((uint32_t)s1 ^ (uint32_t)s2) & 3) == 0) {
+        while ((uint32_t)s1 & 3) {
+            if (*s1 == '\0' || *s1 != *s2) {
+                return *(const unsigned char*)s1 - *(const unsigned char*)s2;
+            }
+            s1++;
+            s2++;
+        }
+        const uint32_t *w1 = (const uint32_t *)s1;
+        const uint32_t *w2 = (const uint32_t *)s2;
+        while (*w1 == *w2 && !HAS_ZERO_BYTE(*w1)) {
+            w1++;
+            w2++;
+        }
+        // The byte loop below finds the exact difference or terminator.
+        s1 = (const char *)w1;
+        s2 = (const char *)w2;
+    }
+
     while (*s1 && (*s1 == *s2)) {
         s1++;
         s2++;
@@ -16,53 +43,45 @@ int strcmp(const char *s1, const char *s2)
 
 /**
  * @brief Calculates the length of a string.
+ *
+ * Scans byte by byte up to a word boundary, then one word per load until a
+ * word contains the terminator.
  * @return The number of characters in the string.
  */
 int strlen(const char *s)
 {
-    int len = 0;
-    while (s[len]) {
-        len++;
+    const char *p = s;
+
+    while ((uint32_t)p & 3) {
+        if (*p == '\0') {
+            return p - s;
+        }
+        p++;
     }
-    return len;
-}
 
-/**
- * @brief Reverses a string in place. Helper for itoa.
- */
-static void reverse(char s[])
-{
-    int i, j;
-    char c;
-    for (i = 0, j = strlen(s)-1; i<j; i++, j--) {
-        c = s[i];
-        s[i] = s[j];
-        s[j] = c;
+    const uint32_t *w = (const uint32_t *)p;
+    while (!HAS_ZERO_BYTE(*w)) {
+        w++;
     }
+
+    p = (const char *)w;
+    while (*p) {
+        p++;
+    }
+    return p - s;
 }
 
 /**
  * @brief Converts an integer to a null-terminated string (ASCII).
+ *
+ * Digits are produced in order by the kprintf converter, without a
+ * reverse pass or a division per digit.
  * @param n The integer to convert.
- * @param s Buffer to store the resulting string.
+ * @param s Buffer to store the resulting string (at least 12 bytes).
  */
 void itoa(int n, char *s)
 {
-    int i = 0, sign;
-
-    if ((sign = n) < 0) {
-        n = -n;
-    }
-
-    do {
-        s[i++] = n % 10 + '0';
-    } while ((n /= 10) > 0);
-
-    if (sign < 0) {
-        s[i++] = '-';
-    }
-    s[i] = '\0';
-    reverse(s);
+    ksnprintf(s, 12, "%d", n);
 }
 
 /**
@@ -0,0 +1,254 @@
+#include "reg.h"
+#include "cpu.h"
+#include "nvic.h"
+#include "ring.h"
+#include "sched.h"
+#include "sync.h"
+#include "sysclk.h"
+#include "systick.h"
+#include "trace.h"
+#include "workq.h"
+
+void print_str(const char *str);
+void itoa(int n, char *s);
+
+#define WORK_TEST_ROUNDS  1000 // Loop iterations of the 'workbench' item
+
+static WorkItem *work_buf[WORK_PRIORITIES][WORK_QUEUE_DEPTH];
+static uint8_t work_seq[WORK_PRIORITIES][WORK_QUEUE_DEPTH];
+static Ring work_queue[WORK_PRIORITIES];
+static Semaphore work_sem;       // Given once per successful post
+static WorkItem *work_items;     // Every initialised item, for 'workq'
+static uint32_t work_overflows;  // Posts rejected because a queue was full
+
+// 'workbench' state. The ISR fields are only written by the test ISR.
+static WorkItem work_test_item;
+static volatile uint32_t work_test_isr_count;
+static volatile uint32_t work_test_isr_max;
+static volatile uint64_t work_test_isr_total;
+static volatile uint32_t work_test_sum;
+
+/**
+ * @brief Takes the oldest item of the highest-priority non-empty queue.
+ * @return The item, or NULL if every queue is empty.
+ */
+static WorkItem *work_next(void)
+{
+    WorkItem *w;
+    for (int p = 0; p < WORK_PRIORITIES; p++) {
+        if (ring_pop(&work_queue[p], &w)) {
+            return w;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Worker task: runs queued items with interrupts enabled.
+ *
+ * Each wake-up drains every queue rather than one item per semaphore unit,
+ * so an item whose producer was preempted before committing it is still run
+ * promptly; surplus units only cause an empty pass.
+ */
+static void work_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        sem_take(&work_sem);
+
+        WorkItem *w;
+        while ((w = work_next()) != NULL) {
+            // Post time is read before pending is cleared: once it is 0 an
+            // ISR may post again and overwrite posted_at. Cleared before the
+            // call so that a post while the item runs queues it again.
+            uint32_t posted_at = w->posted_at;
+            w->pending = 0;
+            uint32_t start = (uint32_t)time_cycles();
+            uint32_t latency = start - posted_at;
+
+            w->fn(w->arg);
+
+            uint32_t cycles = (uint32_t)time_cycles() - start;
+            TRACE(TRACE_EV_WORK_RUN, w, cycles);
+            w->runs++;
+            w->total_cycles += cycles;
+            if (cycles > w->max_cycles) w->max_cycles = cycles;
+            if (latency > w->max_latency) w->max_latency = latency;
+        }
+    }
+}
+
+/**
+ * @brief Creates the queues and the 'work' task. Call after sched_init().
+ */
+void workq_init(void)
+{
+    for (int p = 0; p < WORK_PRIORITIES; p++) {
+        ring_init(&work_queue[p], work_buf[p], work_seq[p], sizeof(WorkItem *), WORK_QUEUE_DEPTH);
+    }
+    sem_init(&work_sem, "workq", 0);
+    task_create("work", work_task, NULL, WORK_TASK_PRIORITY, WORK_STACK_SIZE);
+}
+
+/**
+ * @brief Initialises a work item. Items are usually static and posted again
+ *        and again; they are never freed.
+ * @param priority 0 (highest) to WORK_PRIORITIES - 1; larger values are clamped.
+ */
+void work_init(WorkItem *w, const char *name, WorkFn fn, void *arg, uint32_t priority)
+{
+    w->fn = fn;
+    w->arg = arg;
+    w->name = name;
+    w->priority = (uint8_t)(priority < WORK_PRIORITIES ? priority : WORK_PRIORITIES - 1);
+    w->pending = 0;
+    w->posted_at = 0;
+    w->posts = 0;
+    w->coalesced = 0;
+    w->runs = 0;
+    w->max_cycles = 0;
+    w->max_latency = 0;
+    w->total_cycles = 0;
+
+    uint32_t primask = irq_save();
+    w->next = work_items;
+    work_items = w;
+    irq_restore(primask);
+}
+
+/**
+ * @brief Queues a work item for the 'work' task. Safe from any ISR or task.
+ *
+ * The pending claim and the ring push are lock-free. Interrupts are masked
+ * only briefly: for the timestamp read in time_cycles(), and inside
+ * sem_give() when it has to wake a blocked worker.
+ *
+ * If the item is already queued the post is merged with it, so the function
+ * runs once for a burst of posts.
+ * @return 1 if queued, 0 if merged with a pending post, -1 if its queue was full.
+ */
+int work_post(WorkItem *w)
+{
+    do {
+        if (cpu_ldrex(&w->pending) != 0) {
+            cpu_clrex();
+            w->coalesced++;
+            return 0;
+        }
+    } while (cpu_strex(1, &w->pending) != 0);
+
+    w->posted_at = (uint32_t)time_cycles();
+    if (!ring_mp_push(&work_queue[w->priority], &w)) {
+        w->pending = 0;
+        work_overflows++;
+        return -1;
+    }
+    w->posts++;
+    TRACE(TRACE_EV_WORK_POST, w, w->priority);
+    sem_give(&work_sem);
+    return 1;
+}
+
+/**
+ * @brief Lists the work items and their timing ('workq' command).
+ */
+void workq_print_stats(void)
+{
+    char num[12];
+    uint32_t cycles_per_us = sysclk_get_hz() / 1000000;
+
+    print_str("Work queue: Overflows: "); itoa(work_overflows, num); print_str(num);
+    print_str(" | Queued:");
+    for (int p = 0; p < WORK_PRIORITIES; p++) {
+        print_str(" "); itoa(ring_count(&work_queue[p]), num); print_str(num);
+    }
+    print_str(" (by priority)\n");
+
+    for (WorkItem *w = work_items; w != NULL; w = w->next) {
+        print_str("  "); print_str(w->name);
+        print_str(" | Prio: "); itoa(w->priority, num); print_str(num);
+        print_str(" | Posts: "); itoa(w->posts, num); print_str(num);
+        print_str(" | Merged: "); itoa(w->coalesced, num); print_str(num);
+        print_str(" | Runs: "); itoa(w->runs, num); print_str(num);
+        if (w->runs != 0) {
+            print_str(" | Exec avg/max: ");
+            itoa((uint32_t)(w->total_cycles / w->runs) / cycles_per_us, num); print_str(num);
+            print_str("/"); itoa(w->max_cycles / cycles_per_us, num); print_str(num);
+            print_str(" us | Latency max: "); itoa(w->max_latency / cycles_per_us, num); print_str(num);
+            print_str(" us");
+        }
+        print_str("\n");
+    }
+}
+
+/**
+ * @brief Test work: a hash loop standing in for processing an ISR would
+ *        otherwise do itself.
+ */
+static void work_test_fn(void *arg)
+{
+    (void)arg;
+    uint32_t hash = 5381;
+    for (uint32_t i = 0; i < WORK_TEST_ROUNDS; i++) {
+        hash = hash * 33 + i;
+    }
+    work_test_sum = hash;
+}
+
+/**
+ * @brief Test interrupt: overrides the weak WORK_TEST_IRQ vector. Only posts
+ *        the test item and times itself.
+ */
+RAMFUNC void flash_isr(void)
+{
+    uint32_t start = (uint32_t)time_cycles();
+    work_post(&work_test_item);
+    uint32_t cycles = (uint32_t)time_cycles() - start;
+
+    work_test_isr_count++;
+    work_test_isr_total += cycles;
+    if (cycles > work_test_isr_max) work_test_isr_max = cycles;
+}
+
+/**
+ * @brief Triggers WORK_TEST_IRQ 'count' times and reports how long the ISR
+ *        took versus the deferred work it posted ('workbench').
+ */
+void workq_test(uint32_t count)
+{
+    char num[12];
+    uint32_t cycles_per_us = sysclk_get_hz() / 1000000;
+
+    if (count == 0) return;
+    if (work_test_item.fn == NULL) {
+        work_init(&work_test_item, "test", work_test_fn, NULL, WORK_PRIORITIES - 1);
+    }
+    uint32_t runs_before = work_test_item.runs;
+    work_test_isr_count = 0;
+    work_test_isr_total = 0;
+    work_test_isr_max = 0;
+
+    nvic_set_priority(WORK_TEST_IRQ, NVIC_PRIO_LOWEST - 1);
+    nvic_clear_pending(WORK_TEST_IRQ);
+    nvic_enable_irq(WORK_TEST_IRQ);
+    for (uint32_t i = 0; i < count; i++) {
+        *(NVIC_SW_TRIG) = WORK_TEST_IRQ;
+        task_yield(); // The worker has a higher priority and has already run here.
+    }
+    nvic_disable_irq(WORK_TEST_IRQ);
+
+    uint32_t isr_count = work_test_isr_count;
+    if (isr_count == 0) {
+        print_str("Error: test IRQ never fired.\n");
+        return;
+    }
+    print_str("Deferred work test ("); itoa(isr_count, num); print_str(num); print_str(" interrupts):\n");
+    print_str("  ISR avg/max: ");
+    itoa((uint32_t)(work_test_isr_total / isr_count), num); print_str(num);
+    print_str("/"); itoa(work_test_isr_max, num); print_str(num); print_str(" cycles\n");
+    print_str("  Work runs: "); itoa(work_test_item.runs - runs_before, num); print_str(num);
+    print_str(" | Exec max: "); itoa(work_test_item.max_cycles / cycles_per_us, num); print_str(num);
+    print_str(" us | Latency max: "); itoa(work_test_item.max_latency / cycles_per_us, num); print_str(num);
+    print_str(" us\n");
+}
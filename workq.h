@@ -0,0 +1,51 @@
+#ifndef __WORKQ_H_
+#define __WORKQ_H_
+
+#include <stdint.h>
+#include "reg.h"
+
+/*
+ * Deferred work (bottom half) untuk ISR.
+ * - ISR cukup memanggil work_post(): item masuk ring MPSC lock-free sesuai
+ *   prioritasnya, lalu semaphore membangunkan task 'work'. Interrupt hanya
+ *   dimatikan sebentar (baca timestamp, dan sem_give() bila worker menunggu).
+ * - Task 'work' (prioritas tinggi) menjalankan item dengan interrupt aktif,
+ *   selalu dari antrian prioritas tertinggi yang tidak kosong.
+ * - Post ganda sebelum item sempat jalan digabung (dijalankan sekali).
+ * - Setiap item mencatat jumlah eksekusi, waktu eksekusi dan latensi dari
+ *   post sampai mulai jalan; lihat perintah 'workq'.
+ */
+#define WORK_PRIORITIES      4    // 0 = tertinggi
+#define WORK_QUEUE_DEPTH     16   // Item per prioritas (pangkat dua)
+#define WORK_TASK_PRIORITY   1    // Di atas timer dan shell
+#define WORK_STACK_SIZE      1024
+
+// IRQ untuk 'workbench'. Flash controller tidak dipakai driver mana pun,
+// jadi vector-nya dipinjam di sini (seperti NVIC_LATENCY_IRQ).
+#define WORK_TEST_IRQ        IRQ_FLASH
+
+typedef void (*WorkFn)(void *arg);
+
+typedef struct WorkItem {
+    WorkFn fn;
+    void *arg;
+    const char *name;          // Nama untuk perintah 'workq'
+    uint8_t priority;          // 0..WORK_PRIORITIES-1
+    volatile uint32_t pending; // 1 selama item ada di antrian
+    uint32_t posted_at;        // time_cycles() saat post (32 bit bawah)
+    uint32_t posts;            // Post yang masuk antrian
+    uint32_t coalesced;        // Post yang digabung karena item masih pending
+    uint32_t runs;
+    uint32_t max_cycles;       // Eksekusi terlama
+    uint32_t max_latency;      // Post -> mulai jalan terlama (siklus)
+    uint64_t total_cycles;
+    struct WorkItem *next;     // Daftar semua item
+} WorkItem;
+
+void workq_init(void);
+void work_init(WorkItem *w, const char *name, WorkFn fn, void *arg, uint32_t priority);
+int work_post(WorkItem *w);
+void workq_print_stats(void);
+void workq_test(uint32_t count);
+
+#endif // __WORKQ_H_